@@ -0,0 +1,202 @@
+#include "CircleBatch.h"
+#include "Profiler.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <cstddef>
+
+// Unit quad as two triangles, scaled and moved per instance. With y pointing
+// down, as in raylib's 2D projection, this order is counter-clockwise on
+// screen, so rlgl's back-face culling keeps them.
+const float quadCorners[12] = {
+    -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f,
+    -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, -1.0f};
+
+const char *circleVertexShader = R"(#version 330
+in vec2 vertexCorner;
+in vec3 instanceCircle;
+in vec4 instanceColor;
+uniform mat4 mvp;
+out vec2 fragCorner;
+out vec4 fragColor;
+void main()
+{
+    fragCorner = vertexCorner;
+    fragColor = instanceColor;
+    gl_Position = mvp * vec4(instanceCircle.xy + vertexCorner * instanceCircle.z, 0.0, 1.0);
+}
+)";
+
+const char *circleFragmentShader = R"(#version 330
+in vec2 fragCorner;
+in vec4 fragColor;
+out vec4 finalColor;
+void main()
+{
+    if (dot(fragCorner, fragCorner) > 1.0) discard;
+    finalColor = fragColor;
+}
+)";
+
+// Fallback texture size, large enough that scaled circles keep a clean edge
+const int circleTextureSize = 128;
+
+void LoadInstanceBuffer(CircleBatch &batch, int capacity);
+
+void InitCircleBatch(CircleBatch &batch, bool allowInstancing)
+{
+    batch = CircleBatch{};
+
+    // Fallback texture, also kept when instancing works so either path can draw.
+    // Texels whose centers are inside the circle are set, so it sits exactly
+    // in the middle and fills the quad the way DrawCircleV fills its radius;
+    // ImageDrawCircle centers on a texel, which is half a texel off.
+    Image image = GenImageColor(circleTextureSize, circleTextureSize, BLANK);
+    float textureRadius = 0.5f * circleTextureSize;
+    for (int y = 0; y < circleTextureSize; ++y)
+    {
+        for (int x = 0; x < circleTextureSize; ++x)
+        {
+            float dx = x + 0.5f - textureRadius;
+            float dy = y + 0.5f - textureRadius;
+            if (dx * dx + dy * dy <= textureRadius * textureRadius)
+            {
+                ImageDrawPixel(&image, x, y, WHITE);
+            }
+        }
+    }
+    batch.circleTexture = LoadTextureFromImage(image);
+    UnloadImage(image);
+
+    int version = rlGetVersion();
+    if (!allowInstancing || (version != RL_OPENGL_33 && version != RL_OPENGL_43))
+    {
+        return;
+    }
+
+    batch.shader = rlLoadShaderCode(circleVertexShader, circleFragmentShader);
+    if (batch.shader == 0 || batch.shader == rlGetShaderIdDefault())
+    {
+        TraceLog(LOG_WARNING, "CIRCLES: Instanced shader failed, using textured quads");
+        batch.shader = 0;
+        return;
+    }
+    batch.mvpLoc = rlGetLocationUniform(batch.shader, "mvp");
+
+    batch.vao = rlLoadVertexArray();
+    rlEnableVertexArray(batch.vao);
+
+    int cornerLoc = rlGetLocationAttrib(batch.shader, "vertexCorner");
+    batch.quadVbo = rlLoadVertexBuffer(quadCorners, sizeof(quadCorners), false);
+    rlSetVertexAttribute(cornerLoc, 2, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(cornerLoc);
+
+    LoadInstanceBuffer(batch, 1024);
+
+    rlDisableVertexArray();
+    batch.instanced = true;
+}
+
+// (Re)creates the per-instance buffer; the batch's vertex array must be bound
+void LoadInstanceBuffer(CircleBatch &batch, int capacity)
+{
+    if (batch.instanceVbo != 0)
+    {
+        rlUnloadVertexBuffer(batch.instanceVbo);
+    }
+    batch.instanceVbo = rlLoadVertexBuffer(nullptr, capacity * sizeof(CircleInstance), true);
+    batch.instanceCapacity = capacity;
+
+    int circleLoc = rlGetLocationAttrib(batch.shader, "instanceCircle");
+    rlSetVertexAttribute(circleLoc, 3, RL_FLOAT, false, sizeof(CircleInstance), (const void *)offsetof(CircleInstance, x));
+    rlSetVertexAttributeDivisor(circleLoc, 1);
+    rlEnableVertexAttribute(circleLoc);
+
+    int colorLoc = rlGetLocationAttrib(batch.shader, "instanceColor");
+    rlSetVertexAttribute(colorLoc, 4, RL_UNSIGNED_BYTE, true, sizeof(CircleInstance), (const void *)offsetof(CircleInstance, color));
+    rlSetVertexAttributeDivisor(colorLoc, 1);
+    rlEnableVertexAttribute(colorLoc);
+}
+
+void UnloadCircleBatch(CircleBatch &batch)
+{
+    if (batch.instanced)
+    {
+        rlUnloadVertexBuffer(batch.instanceVbo);
+        rlUnloadVertexBuffer(batch.quadVbo);
+        rlUnloadVertexArray(batch.vao);
+        rlUnloadShaderProgram(batch.shader);
+    }
+    UnloadTexture(batch.circleTexture);
+    batch = CircleBatch{};
+}
+
+void DrawCircleBatchInstanced(CircleBatch &batch)
+{
+    int count = (int)batch.instances.size();
+
+    // Flush raylib's own batch first so draw order is kept
+    rlDrawRenderBatchActive();
+
+    rlEnableVertexArray(batch.vao);
+    if (count > batch.instanceCapacity)
+    {
+        int capacity = batch.instanceCapacity;
+        while (capacity < count)
+        {
+            capacity *= 2;
+        }
+        LoadInstanceBuffer(batch, capacity);
+    }
+    rlUpdateVertexBuffer(batch.instanceVbo, batch.instances.data(), count * sizeof(CircleInstance), 0);
+
+    rlEnableShader(batch.shader);
+    rlSetUniformMatrix(batch.mvpLoc, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+    rlDrawVertexArrayInstanced(0, 6, count);
+    rlDisableShader();
+    rlDisableVertexArray();
+}
+
+void DrawCircleBatchQuads(CircleBatch &batch)
+{
+    rlSetTexture(batch.circleTexture.id);
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (const CircleInstance &circle : batch.instances)
+    {
+        float left = circle.x - circle.radius;
+        float top = circle.y - circle.radius;
+        float right = circle.x + circle.radius;
+        float bottom = circle.y + circle.radius;
+
+        rlCheckRenderBatchLimit(4);
+        rlColor4ub(circle.color.r, circle.color.g, circle.color.b, circle.color.a);
+        rlTexCoord2f(0.0f, 0.0f);
+        rlVertex2f(left, top);
+        rlTexCoord2f(0.0f, 1.0f);
+        rlVertex2f(left, bottom);
+        rlTexCoord2f(1.0f, 1.0f);
+        rlVertex2f(right, bottom);
+        rlTexCoord2f(1.0f, 0.0f);
+        rlVertex2f(right, top);
+    }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+void DrawCircleBatch(CircleBatch &batch)
+{
+    PROFILE_SCOPE("DrawCircleBatch");
+    if (batch.instances.empty())
+    {
+        return;
+    }
+
+    if (batch.instanced)
+    {
+        DrawCircleBatchInstanced(batch);
+    }
+    else
+    {
+        DrawCircleBatchQuads(batch);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef CIRCLE_BATCH_H
+#define CIRCLE_BATCH_H
+
+#include "raylib.h"
+#include <vector>
+
+// Draws many solid circles at once. Circles are collected on the CPU, then
+// uploaded as one instance buffer per frame and drawn with a single instanced
+// call of a quad whose fragment shader cuts out the circle.
+//
+// Without instancing support (OpenGL 1.1/2.1/ES2, or a shader that failed to
+// build) it falls back to one textured quad per circle through raylib's
+// render batch, which is still far cheaper than tessellating with DrawCircleV.
+
+struct CircleInstance
+{
+    float x;
+    float y;
+    float radius;
+    Color color;
+};
+
+struct CircleBatch
+{
+    std::vector<CircleInstance> instances;
+    bool instanced;
+
+    // Instanced path
+    unsigned int shader;
+    int mvpLoc;
+    unsigned int vao;
+    unsigned int quadVbo;
+    unsigned int instanceVbo;
+    int instanceCapacity;
+
+    // Fallback path
+    Texture2D circleTexture;
+};
+
+// Needs an OpenGL context, call after InitWindow
+void InitCircleBatch(CircleBatch &batch, bool allowInstancing = true);
+void UnloadCircleBatch(CircleBatch &batch);
+
+inline void ClearCircleBatch(CircleBatch &batch)
+{
+    batch.instances.clear();
+}
+
+inline void AddCircle(CircleBatch &batch, float x, float y, float radius, Color color)
+{
+    batch.instances.push_back({x, y, radius, color});
+}
+
+// Draws every queued circle in order, after anything raylib already queued
+void DrawCircleBatch(CircleBatch &batch);
+
+#endif
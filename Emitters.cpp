@@ -0,0 +1,62 @@
+#include "Emitters.h"
+#include <cmath>
+
+const float pi = 3.14159265358979f;
+
+Emitter MakeEmitter(EmitterPattern pattern, int count, float speed, float radius, float interval, Rgba color)
+{
+    Emitter emitter = {};
+    emitter.pattern = pattern;
+    emitter.count = count;
+    emitter.speed = speed;
+    emitter.radius = radius;
+    emitter.interval = interval;
+    emitter.color = color;
+    return emitter;
+}
+
+void FireEmitter(Emitter &emitter, EntityArrays &bullets, Vec2 origin, Vec2 target)
+{
+    if (emitter.count <= 0)
+    {
+        return;
+    }
+
+    // Direction of the first bullet and the turn between two bullets
+    float start = emitter.angle;
+    float step = 2.0f * pi / emitter.count;
+    if (emitter.pattern == EMITTER_AIMED || emitter.pattern == EMITTER_SPREAD)
+    {
+        float center = emitter.angle;
+        if (emitter.pattern == EMITTER_AIMED)
+        {
+            center = std::atan2(target.y - origin.y, target.x - origin.x);
+        }
+        step = emitter.count > 1 ? emitter.spread / (emitter.count - 1) : 0.0f;
+        start = center - 0.5f * step * (emitter.count - 1);
+    }
+
+    // Rotate the direction bullet by bullet instead of calling sin/cos each time
+    float dirX = std::cos(start);
+    float dirY = std::sin(start);
+    float stepCos = std::cos(step);
+    float stepSin = std::sin(step);
+
+    int first = AddEntities(bullets, emitter.count);
+    for (int i = first; i < bullets.count; ++i)
+    {
+        bullets.x[i] = origin.x;
+        bullets.y[i] = origin.y;
+        bullets.vx[i] = dirX * emitter.speed;
+        bullets.vy[i] = dirY * emitter.speed;
+        bullets.radius[i] = emitter.radius;
+        bullets.color[i] = emitter.color;
+        bullets.active[i] = 1;
+
+        float nextX = dirX * stepCos - dirY * stepSin;
+        dirY = dirX * stepSin + dirY * stepCos;
+        dirX = nextX;
+    }
+
+    emitter.angle = std::fmod(emitter.angle + emitter.spin, 2.0f * pi);
+}
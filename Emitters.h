@@ -0,0 +1,40 @@
+#ifndef EMITTERS_H
+#define EMITTERS_H
+
+#include "EntityArrays.h"
+#include "SimMath.h"
+
+// Data-driven bullet patterns. An emitter fires a volley of bullets every
+// interval straight into the bullet arrays; storage is reserved once per
+// volley so spawning does not allocate once the pool has grown. When to fire
+// is up to the owner's clock.
+
+enum EmitterPattern
+{
+    EMITTER_RING,   // count bullets evenly around a full circle
+    EMITTER_SPIRAL, // a ring that turns by spin radians every volley
+    EMITTER_AIMED,  // a fan of spread radians centered on the target
+    EMITTER_SPREAD  // a fan of spread radians centered on angle
+};
+
+struct Emitter
+{
+    EmitterPattern pattern;
+    int count;       // bullets per volley
+    float speed;     // pixels per second
+    float radius;
+    float interval;  // seconds between volleys
+    float spread;    // fan width in radians, aimed and spread only
+    float spin;      // radians added to angle after each volley
+    Rgba color;
+
+    // State
+    float angle;     // radians, direction of the first bullet
+};
+
+Emitter MakeEmitter(EmitterPattern pattern, int count, float speed, float radius, float interval, Rgba color);
+
+// Fires one volley from origin; target is only used by aimed emitters
+void FireEmitter(Emitter &emitter, EntityArrays &bullets, Vec2 origin, Vec2 target);
+
+#endif
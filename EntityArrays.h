@@ -0,0 +1,144 @@
+#ifndef ENTITY_ARRAYS_H
+#define ENTITY_ARRAYS_H
+
+#include "SimMath.h"
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+
+// Widest SIMD register in floats (AVX2). Array capacity is rounded up to it so
+// kernels can run whole lanes.
+const int entityLanes = 8;
+const size_t entityAlignment = 32;
+
+template <typename T>
+struct AlignedAllocator
+{
+    typedef T value_type;
+
+    AlignedAllocator() {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U> &) {}
+
+    T *allocate(size_t count)
+    {
+        void *memory = nullptr;
+#ifdef _WIN32
+        memory = _aligned_malloc(count * sizeof(T), entityAlignment);
+#else
+        if (posix_memalign(&memory, entityAlignment, count * sizeof(T)) != 0)
+        {
+            memory = nullptr;
+        }
+#endif
+        if (!memory)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(memory);
+    }
+
+    void deallocate(T *memory, size_t)
+    {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        free(memory);
+#endif
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T> &, const AlignedAllocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T> &, const AlignedAllocator<U> &) { return false; }
+
+typedef std::vector<float, AlignedAllocator<float>> FloatArray;
+
+// Structure-of-arrays storage for moving circles. Entity i is made of x[i],
+// y[i], vx[i], vy[i], radius[i], color[i] and active[i].
+struct EntityArrays
+{
+    int count;
+    FloatArray x;
+    FloatArray y;
+    FloatArray vx;
+    FloatArray vy;
+    FloatArray radius;
+    std::vector<Rgba> color;
+    std::vector<unsigned char> active;
+};
+
+// Grows storage to hold at least capacity entities without changing count.
+// New and padding entries are zeroed.
+inline void ReserveEntityArrays(EntityArrays &entities, int capacity)
+{
+    size_t size = (size_t)((capacity + entityLanes - 1) / entityLanes * entityLanes);
+    if (size <= entities.x.size())
+    {
+        return;
+    }
+    entities.x.resize(size, 0.0f);
+    entities.y.resize(size, 0.0f);
+    entities.vx.resize(size, 0.0f);
+    entities.vy.resize(size, 0.0f);
+    entities.radius.resize(size, 0.0f);
+    entities.color.resize(size, Rgba{0, 0, 0, 0});
+    entities.active.resize(size, 0);
+}
+
+// Sets the entity count, growing storage if needed
+inline void ResizeEntityArrays(EntityArrays &entities, int count)
+{
+    ReserveEntityArrays(entities, count);
+    entities.count = count;
+}
+
+// Appends count entities and returns the index of the first. Storage at least
+// doubles when full, so the cost is amortized O(1) per entity; reserve ahead to
+// keep allocation off the hot path entirely.
+inline int AddEntities(EntityArrays &entities, int count)
+{
+    int first = entities.count;
+    size_t needed = (size_t)(first + count);
+    if (needed > entities.x.size())
+    {
+        size_t doubled = entities.x.size() * 2;
+        ReserveEntityArrays(entities, (int)(needed > doubled ? needed : doubled));
+    }
+    entities.count = first + count;
+    return first;
+}
+
+// Removes entity i by moving the last entity into its place
+inline void RemoveEntity(EntityArrays &entities, int i)
+{
+    int last = --entities.count;
+    entities.x[i] = entities.x[last];
+    entities.y[i] = entities.y[last];
+    entities.vx[i] = entities.vx[last];
+    entities.vy[i] = entities.vy[last];
+    entities.radius[i] = entities.radius[last];
+    entities.color[i] = entities.color[last];
+    entities.active[i] = entities.active[last];
+}
+
+// Removes every inactive entity, keeping the live ones dense
+inline void RemoveInactiveEntities(EntityArrays &entities)
+{
+    for (int i = entities.count - 1; i >= 0; --i)
+    {
+        if (!entities.active[i])
+        {
+            RemoveEntity(entities, i);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef ENTITY_HANDLES_H
+#define ENTITY_HANDLES_H
+
+#include "EntityArrays.h"
+#include <cstdint>
+#include <vector>
+
+// Generational handles for entities kept dense in EntityArrays. Removal moves
+// the last entity into the freed place, so a plain index goes stale; a handle
+// names a slot that follows its entity, and the slot's generation changes when
+// the entity goes so old handles stop resolving instead of aliasing whatever
+// reuses the slot.
+
+struct EntityHandle
+{
+    uint32_t slot;
+    uint32_t generation;
+};
+
+const EntityHandle nullEntityHandle = {0xFFFFFFFFu, 0};
+
+struct EntityHandles
+{
+    std::vector<uint32_t> slotOf;     // dense index -> slot
+    std::vector<int> denseOf;         // slot -> dense index, -1 when free
+    std::vector<uint32_t> generation; // per slot, bumped on release
+    std::vector<uint32_t> freeSlots;  // reused last in, first out
+};
+
+inline bool operator==(EntityHandle a, EntityHandle b) { return a.slot == b.slot && a.generation == b.generation; }
+inline bool operator!=(EntityHandle a, EntityHandle b) { return !(a == b); }
+
+// Appends count entities like AddEntities and gives each a slot
+inline int AddHandledEntities(EntityArrays &entities, EntityHandles &handles, int count)
+{
+    int first = AddEntities(entities, count);
+    handles.slotOf.resize(entities.count);
+    for (int i = first; i < entities.count; ++i)
+    {
+        uint32_t slot;
+        if (!handles.freeSlots.empty())
+        {
+            slot = handles.freeSlots.back();
+            handles.freeSlots.pop_back();
+        }
+        else
+        {
+            slot = (uint32_t)handles.denseOf.size();
+            handles.denseOf.push_back(-1);
+            handles.generation.push_back(1);
+        }
+        handles.denseOf[slot] = i;
+        handles.slotOf[i] = slot;
+    }
+    return first;
+}
+
+inline EntityHandle GetEntityHandle(const EntityHandles &handles, int i)
+{
+    uint32_t slot = handles.slotOf[i];
+    return {slot, handles.generation[slot]};
+}
+
+// Current index of the entity, or -1 once it has been removed
+inline int ResolveEntityHandle(const EntityHandles &handles, EntityHandle handle)
+{
+    if (handle.slot >= handles.denseOf.size() || handles.generation[handle.slot] != handle.generation)
+    {
+        return -1;
+    }
+    return handles.denseOf[handle.slot];
+}
+
+// RemoveEntity that keeps the moved entity's handle pointing at it
+inline void RemoveHandledEntity(EntityArrays &entities, EntityHandles &handles, int i)
+{
+    uint32_t slot = handles.slotOf[i];
+    handles.generation[slot]++;
+    handles.denseOf[slot] = -1;
+    handles.freeSlots.push_back(slot);
+
+    int last = entities.count - 1;
+    handles.slotOf[i] = handles.slotOf[last];
+    if (i != last)
+    {
+        handles.denseOf[handles.slotOf[i]] = i;
+    }
+    handles.slotOf.pop_back();
+    RemoveEntity(entities, i);
+}
+
+inline void RemoveInactiveHandledEntities(EntityArrays &entities, EntityHandles &handles)
+{
+    for (int i = entities.count - 1; i >= 0; --i)
+    {
+        if (!entities.active[i])
+        {
+            RemoveHandledEntity(entities, handles, i);
+        }
+    }
+}
+
+// Removes every entity; all outstanding handles stop resolving
+inline void ClearHandledEntities(EntityArrays &entities, EntityHandles &handles)
+{
+    for (int i = entities.count - 1; i >= 0; --i)
+    {
+        RemoveHandledEntity(entities, handles, i);
+    }
+}
+
+#endif
@@ -0,0 +1,180 @@
+#include "FlowField.h"
+#include <cmath>
+
+// Steering tuning
+const float steerRate = 4.0f;          // fraction of the speed error corrected per second
+const float separationGradient = 0.5f; // speed per unit of density difference, in speeds
+const float separationCentroid = 0.5f; // speed away from the cell centroid per extra entity, in speeds
+
+const int neighborCount = 8;
+const int neighborColumn[neighborCount] = {1, -1, 0, 0, 1, 1, -1, -1};
+const int neighborRow[neighborCount] = {0, 0, 1, -1, 1, -1, 1, -1};
+const int neighborCost[neighborCount] = {2, 2, 2, 2, 3, 3, 3, 3};
+
+void InitFlowField(FlowField &field, float width, float height, float cellSize)
+{
+    field.cellSize = cellSize;
+    field.columns = (int)(width / cellSize) + 1;
+    field.rows = (int)(height / cellSize) + 1;
+    field.targetCell = -1;
+    field.target = {0.0f, 0.0f};
+
+    int cellCount = field.columns * field.rows;
+    field.distance.assign(cellCount, 0);
+    field.direction.assign(cellCount, Vec2{0.0f, 0.0f});
+    field.density.assign(cellCount, 0.0f);
+    field.centroid.assign(cellCount, Vec2{0.0f, 0.0f});
+}
+
+// Dial's algorithm: with step costs of at most 3, cells at distance d only
+// ever add cells at d + 2 or d + 3, so four buckets reused in turn replace a
+// priority queue and every cell is expanded once
+void BuildDistances(FlowField &field)
+{
+    const int unreached = 0x7FFFFFFF;
+    field.distance.assign(field.distance.size(), unreached);
+    field.distance[field.targetCell] = 0;
+    field.frontier[0].push_back(field.targetCell);
+
+    for (int d = 0, pending = 1; pending > 0; ++d)
+    {
+        std::vector<int> &bucket = field.frontier[d % 4];
+        for (size_t i = 0; i < bucket.size(); ++i)
+        {
+            int cell = bucket[i];
+            pending--;
+            if (field.distance[cell] != d)
+            {
+                continue; // reached again later by a shorter path
+            }
+
+            int column = cell % field.columns;
+            int row = cell / field.columns;
+            for (int n = 0; n < neighborCount; ++n)
+            {
+                int c = column + neighborColumn[n];
+                int r = row + neighborRow[n];
+                if (c < 0 || c >= field.columns || r < 0 || r >= field.rows)
+                {
+                    continue;
+                }
+                int next = r * field.columns + c;
+                int distance = d + neighborCost[n];
+                if (distance < field.distance[next])
+                {
+                    field.distance[next] = distance;
+                    field.frontier[distance % 4].push_back(next);
+                    pending++;
+                }
+            }
+        }
+        bucket.clear();
+    }
+}
+
+// Unit step down the distance field: central differences inside the grid,
+// one-sided at its edges
+void BuildDirections(FlowField &field)
+{
+    for (int row = 0; row < field.rows; ++row)
+    {
+        for (int column = 0; column < field.columns; ++column)
+        {
+            int cell = row * field.columns + column;
+            int left = column > 0 ? cell - 1 : cell;
+            int right = column + 1 < field.columns ? cell + 1 : cell;
+            int up = row > 0 ? cell - field.columns : cell;
+            int down = row + 1 < field.rows ? cell + field.columns : cell;
+
+            Vec2 gradient = {(float)(field.distance[left] - field.distance[right]),
+                             (float)(field.distance[up] - field.distance[down])};
+            field.direction[cell] = cell == field.targetCell ? Vec2{0.0f, 0.0f} : Vec2Normalize(gradient);
+        }
+    }
+}
+
+bool UpdateFlowField(FlowField &field, Vec2 target)
+{
+    field.target = target;
+    int cell = FlowFieldCell(field, target.x, target.y);
+    if (cell == field.targetCell)
+    {
+        return false;
+    }
+
+    field.targetCell = cell;
+    BuildDistances(field);
+    BuildDirections(field);
+    return true;
+}
+
+void AccumulateDensity(FlowField &field, const EntityArrays &entities)
+{
+    // Only clear what the last pass filled
+    for (int cell : field.occupied)
+    {
+        field.density[cell] = 0.0f;
+        field.centroid[cell] = {0.0f, 0.0f};
+    }
+    field.occupied.clear();
+
+    for (int i = 0; i < entities.count; ++i)
+    {
+        int cell = FlowFieldCell(field, entities.x[i], entities.y[i]);
+        if (field.density[cell] == 0.0f)
+        {
+            field.occupied.push_back(cell);
+        }
+        field.density[cell] += 1.0f;
+        field.centroid[cell].x += entities.x[i];
+        field.centroid[cell].y += entities.y[i];
+    }
+}
+
+void SteerEntities(const FlowField &field, EntityArrays &entities, int begin, int end, float speed, float dt)
+{
+    float blend = ClampFloat(steerRate * dt, 0.0f, 1.0f);
+    for (int i = begin; i < end; ++i)
+    {
+        float x = entities.x[i];
+        float y = entities.y[i];
+        int cell = FlowFieldCell(field, x, y);
+        int column = cell % field.columns;
+        int row = cell / field.columns;
+
+        // In the target's own cell, head straight for it
+        Vec2 heading = field.direction[cell];
+        if (cell == field.targetCell)
+        {
+            heading = Vec2Normalize({field.target.x - x, field.target.y - y});
+        }
+
+        // Separation: down the density gradient, and apart inside the cell
+        float left = field.density[column > 0 ? cell - 1 : cell];
+        float right = field.density[column + 1 < field.columns ? cell + 1 : cell];
+        float up = field.density[row > 0 ? cell - field.columns : cell];
+        float down = field.density[row + 1 < field.rows ? cell + field.columns : cell];
+        Vec2 push = {(left - right) * separationGradient, (up - down) * separationGradient};
+
+        float crowd = field.density[cell] - 1.0f;
+        if (crowd > 0.0f)
+        {
+            Vec2 centroid = Vec2Scale(field.centroid[cell], 1.0f / field.density[cell]);
+            Vec2 away = Vec2Normalize({x - centroid.x, y - centroid.y});
+            push = Vec2Add(push, Vec2Scale(away, crowd * separationCentroid));
+        }
+
+        // Ease the speed toward the wanted one, capped at speed
+        Vec2 wanted = Vec2Scale(Vec2Add(heading, push), speed);
+        float vx = entities.vx[i] + (wanted.x - entities.vx[i]) * blend;
+        float vy = entities.vy[i] + (wanted.y - entities.vy[i]) * blend;
+        float length = std::sqrt(vx * vx + vy * vy);
+        if (length > speed)
+        {
+            vx *= speed / length;
+            vy *= speed / length;
+        }
+        entities.vx[i] = vx;
+        entities.vy[i] = vy;
+    }
+}
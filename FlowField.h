@@ -0,0 +1,57 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include "EntityArrays.h"
+#include "SimMath.h"
+#include <vector>
+
+// Grid flow field that steers a whole crowd toward one target. A distance
+// field is grown outward from the target's cell (2 per straight step, 3 per
+// diagonal, close to Euclidean) and turned into one direction per cell, so
+// each entity steers with a single lookup however many there are. The field
+// only changes when the target enters another cell; in between it is reused
+// as is.
+//
+// A density grid over the same cells, refilled every tick, gives separation:
+// entities are pushed down the density gradient and away from the centroid
+// of their own cell, without looking at any neighbor individually.
+struct FlowField
+{
+    float cellSize;
+    int columns;
+    int rows;
+    int targetCell; // cell the field was built for, -1 before the first build
+    Vec2 target;
+
+    std::vector<int> distance;   // per cell
+    std::vector<Vec2> direction; // per cell, unit length, zero at the target
+    std::vector<int> frontier[4]; // cells waiting to be expanded, by distance modulo 4
+
+    std::vector<float> density;  // entities per cell
+    std::vector<Vec2> centroid;  // sum of the positions of the entities in each cell
+    std::vector<int> occupied;   // cells with a nonzero density
+};
+
+void InitFlowField(FlowField &field, float width, float height, float cellSize);
+
+inline int FlowFieldCell(const FlowField &field, float x, float y)
+{
+    int column = (int)(x / field.cellSize);
+    int row = (int)(y / field.cellSize);
+    column = column < 0 ? 0 : (column >= field.columns ? field.columns - 1 : column);
+    row = row < 0 ? 0 : (row >= field.rows ? field.rows - 1 : row);
+    return row * field.columns + column;
+}
+
+// Points the field at target, rebuilding the distances only when it moved to
+// another cell. Returns true when it did. O(cells).
+bool UpdateFlowField(FlowField &field, Vec2 target);
+
+// Refills the density grid from the entities, O(count)
+void AccumulateDensity(FlowField &field, const EntityArrays &entities);
+
+// Turns the speed of entities [begin, end) toward the field at up to speed,
+// plus separation. Only reads the field, so ranges can run in parallel.
+void SteerEntities(const FlowField &field, EntityArrays &entities, int begin, int end, float speed, float dt);
+
+#endif
@@ -0,0 +1,124 @@
+#include "Hud.h"
+#include "Profiler.h"
+#include "rlgl.h"
+
+// Empty pixels around each cell, so no quad ever samples its neighbor
+const int hudCellPadding = 2;
+
+void InitHudLayer(HudLayer &hud)
+{
+    hud.atlas = LoadRenderTexture(hudAtlasWidth, hudAtlasHeight);
+    hud.widgets.clear();
+    hud.shelfX = 0;
+    hud.shelfY = 0;
+    hud.shelfHeight = 0;
+
+    BeginTextureMode(hud.atlas);
+    ClearBackground(BLANK);
+    EndTextureMode();
+}
+
+void UnloadHudLayer(HudLayer &hud)
+{
+    UnloadRenderTexture(hud.atlas);
+}
+
+int AddHudWidget(HudLayer &hud, const char *format, Vector2 position, int fontSize, Color color, int value)
+{
+    HudWidget widget = {format, position, fontSize, color, value, true, true, false, {0, 0, 0, 0}};
+    hud.widgets.push_back(widget);
+    return (int)hud.widgets.size() - 1;
+}
+
+// Finds room for a width x height cell on the current shelf, or starts a
+// new shelf below it. False when the atlas is full.
+bool PlaceHudCell(HudLayer &hud, int width, int height, Rectangle &cell)
+{
+    width += 2 * hudCellPadding;
+    height += 2 * hudCellPadding;
+    if (hud.shelfX + width > hudAtlasWidth)
+    {
+        hud.shelfX = 0;
+        hud.shelfY += hud.shelfHeight;
+        hud.shelfHeight = 0;
+    }
+    if (width > hudAtlasWidth || hud.shelfY + height > hudAtlasHeight)
+    {
+        return false;
+    }
+
+    cell = {(float)(hud.shelfX + hudCellPadding), (float)(hud.shelfY + hudCellPadding),
+            (float)(width - 2 * hudCellPadding), (float)(height - 2 * hudCellPadding)};
+    hud.shelfX += width;
+    hud.shelfHeight = height > hud.shelfHeight ? height : hud.shelfHeight;
+    return true;
+}
+
+void UpdateHudLayer(HudLayer &hud)
+{
+    PROFILE_SCOPE("HUD");
+    bool drawing = false;
+    for (HudWidget &widget : hud.widgets)
+    {
+        // Hidden widgets catch up when they are shown again
+        if (!widget.dirty || !widget.visible)
+        {
+            continue;
+        }
+
+        // New cells leave room for a few more digits, so counters rarely move
+        const char *text = TextFormat(widget.format, widget.value);
+        int width = MeasureText(text, widget.fontSize);
+        if (!widget.placed || width > widget.cell.width)
+        {
+            widget.placed = PlaceHudCell(hud, width + 2 * widget.fontSize, widget.fontSize, widget.cell);
+            if (!widget.placed)
+            {
+                continue;
+            }
+        }
+
+        if (!drawing)
+        {
+            BeginTextureMode(hud.atlas);
+            drawing = true;
+        }
+
+        // Overwrite the cell with transparent pixels rather than blending
+        // over the old text, then draw the new text
+        rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+        BeginBlendMode(BLEND_CUSTOM);
+        DrawRectangleRec(widget.cell, BLANK);
+        EndBlendMode();
+        DrawText(text, (int)widget.cell.x, (int)widget.cell.y, widget.fontSize, widget.color);
+        widget.dirty = false;
+    }
+
+    if (drawing)
+    {
+        EndTextureMode();
+    }
+}
+
+void DrawHudLayer(const HudLayer &hud)
+{
+    PROFILE_SCOPE("HUD");
+    for (const HudWidget &widget : hud.widgets)
+    {
+        if (!widget.visible)
+        {
+            continue;
+        }
+        if (!widget.placed)
+        {
+            DrawText(TextFormat(widget.format, widget.value), (int)widget.position.x, (int)widget.position.y,
+                     widget.fontSize, widget.color);
+            continue;
+        }
+
+        // Render textures are stored upside down
+        Rectangle source = {widget.cell.x, hudAtlasHeight - widget.cell.y - widget.cell.height, widget.cell.width,
+                            -widget.cell.height};
+        DrawTextureRec(hud.atlas.texture, source, widget.position, WHITE);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include "raylib.h"
+#include <vector>
+
+// Retained HUD text. Each widget is a line of text bound to one value; it is
+// rasterized into its own cell of an atlas texture when the value changes and
+// otherwise only composited, as one textured quad. Every quad comes from the
+// same texture, so the whole HUD goes out in a single draw call however many
+// widgets there are, and frames where nothing changed do no text work at all.
+//
+// Cells are packed on shelves and sized for the text when it is first drawn.
+// Text that outgrows its cell moves to a new one; a full atlas falls back to
+// drawing that widget directly every frame.
+
+const int hudAtlasWidth = 1024;
+const int hudAtlasHeight = 512;
+
+struct HudWidget
+{
+    const char *format; // TextFormat format with one %d for the value, or plain text
+    Vector2 position;   // on screen
+    int fontSize;
+    Color color;
+
+    int value;
+    bool visible;
+    bool dirty;  // value changed since its text was drawn
+    bool placed; // has a cell
+    Rectangle cell;
+};
+
+struct HudLayer
+{
+    RenderTexture2D atlas;
+    std::vector<HudWidget> widgets;
+
+    // Shelf packing: the current shelf starts at shelfY and is shelfHeight tall
+    int shelfX;
+    int shelfY;
+    int shelfHeight;
+};
+
+// Needs an OpenGL context, call after InitWindow
+void InitHudLayer(HudLayer &hud);
+void UnloadHudLayer(HudLayer &hud);
+
+// Returns the widget's id, for binding values to it
+int AddHudWidget(HudLayer &hud, const char *format, Vector2 position, int fontSize, Color color, int value = 0);
+
+// Only a change of value or visibility costs anything
+inline void SetHudValue(HudLayer &hud, int widget, int value)
+{
+    HudWidget &w = hud.widgets[widget];
+    w.dirty = w.dirty || w.value != value;
+    w.value = value;
+}
+
+inline void SetHudVisible(HudLayer &hud, int widget, bool visible)
+{
+    hud.widgets[widget].visible = visible;
+}
+
+// Redraws the text of changed widgets into the atlas. Call before
+// BeginDrawing, as switching to the atlas flushes raylib's batch.
+void UpdateHudLayer(HudLayer &hud);
+// Composites every visible widget
+void DrawHudLayer(const HudLayer &hud);
+
+#endif
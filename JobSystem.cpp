@@ -0,0 +1,187 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Job
+{
+    JobFunction function;
+    void *context;
+    int begin;
+    int end;
+    std::atomic<int> *pending;
+};
+
+struct WorkerQueue
+{
+    std::mutex mutex;
+    std::deque<Job> jobs;
+};
+
+struct JobSystem
+{
+    std::vector<WorkerQueue> queues; // one per thread, 0 is the creating thread
+    std::vector<std::thread> threads;
+
+    // Idle workers sleep until jobs are queued
+    std::atomic<int> queued;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stop;
+};
+
+// Index of the queue owned by the running thread; threads outside the system
+// use queue 0
+thread_local int workerIndex = 0;
+
+bool PopJob(WorkerQueue &queue, Job &job)
+{
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty())
+    {
+        return false;
+    }
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool StealJob(JobSystem &jobs, int thief, Job &job)
+{
+    int count = (int)jobs.queues.size();
+    for (int offset = 1; offset < count; ++offset)
+    {
+        WorkerQueue &victim = jobs.queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TakeJob(JobSystem &jobs, int index, Job &job)
+{
+    if (PopJob(jobs.queues[index], job) || StealJob(jobs, index, job))
+    {
+        jobs.queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void ExecuteJob(const Job &job)
+{
+    PROFILE_SCOPE("Job");
+    job.function(job.context, job.begin, job.end);
+    job.pending->fetch_sub(1, std::memory_order_release);
+}
+
+void WorkerLoop(JobSystem *jobs, int index)
+{
+    workerIndex = index;
+    for (;;)
+    {
+        Job job;
+        if (TakeJob(*jobs, index, job))
+        {
+            ExecuteJob(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(jobs->sleepMutex);
+        jobs->wake.wait(lock, [jobs] { return jobs->stop || jobs->queued.load() > 0; });
+        if (jobs->stop)
+        {
+            return;
+        }
+    }
+}
+
+JobSystem *CreateJobSystem(int threadCount)
+{
+    if (threadCount <= 0)
+    {
+        threadCount = (int)std::thread::hardware_concurrency();
+        threadCount = threadCount > 0 ? threadCount : 1;
+    }
+
+    JobSystem *jobs = new JobSystem();
+    jobs->queues = std::vector<WorkerQueue>(threadCount);
+    jobs->queued = 0;
+    jobs->stop = false;
+    for (int i = 1; i < threadCount; ++i)
+    {
+        jobs->threads.emplace_back(WorkerLoop, jobs, i);
+    }
+    return jobs;
+}
+
+void DestroyJobSystem(JobSystem *jobs)
+{
+    if (!jobs)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobs->sleepMutex);
+        jobs->stop = true;
+    }
+    jobs->wake.notify_all();
+    for (std::thread &thread : jobs->threads)
+    {
+        thread.join();
+    }
+    delete jobs;
+}
+
+int GetJobThreadCount(const JobSystem *jobs)
+{
+    return jobs ? (int)jobs->queues.size() : 1;
+}
+
+void RunParallelFor(JobSystem *jobs, int count, int grain, JobFunction function, void *context)
+{
+    int index = workerIndex;
+    int chunks = (count + grain - 1) / grain;
+    std::atomic<int> pending(chunks);
+
+    // Queue the ranges back to front so the owner pops them in order
+    {
+        WorkerQueue &queue = jobs->queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (int chunk = chunks - 1; chunk >= 0; --chunk)
+        {
+            int begin = chunk * grain;
+            int end = begin + grain < count ? begin + grain : count;
+            queue.jobs.push_back({function, context, begin, end, &pending});
+        }
+    }
+    jobs->queued.fetch_add(chunks);
+    {
+        std::lock_guard<std::mutex> lock(jobs->sleepMutex);
+    }
+    jobs->wake.notify_all();
+
+    // Help until every range is done, including ones stolen by others
+    while (pending.load(std::memory_order_acquire) > 0)
+    {
+        Job job;
+        if (TakeJob(*jobs, index, job))
+        {
+            ExecuteJob(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
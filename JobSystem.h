@@ -0,0 +1,43 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+// Small work-stealing scheduler. Every thread owns a deque of jobs: it pushes
+// and pops at the back, idle threads steal from the front of the others. The
+// thread that created the system takes part as worker 0.
+//
+// ParallelFor splits [0, count) into ranges of grain items. It returns once
+// every range ran, so the caller can merge per-item results in index order and
+// stay deterministic for any thread count.
+
+struct JobSystem;
+
+typedef void (*JobFunction)(void *context, int begin, int end);
+
+// threadCount includes the calling thread; 0 uses every hardware thread
+JobSystem *CreateJobSystem(int threadCount = 0);
+void DestroyJobSystem(JobSystem *jobs);
+int GetJobThreadCount(const JobSystem *jobs);
+
+void RunParallelFor(JobSystem *jobs, int count, int grain, JobFunction function, void *context);
+
+// Calls body(begin, end) over [0, count), on the calling thread alone when
+// jobs is null or the range fits in one grain
+template <typename Body>
+void ParallelFor(JobSystem *jobs, int count, int grain, Body body)
+{
+    if (!jobs || count <= grain)
+    {
+        if (count > 0)
+        {
+            body(0, count);
+        }
+        return;
+    }
+
+    JobFunction function = [](void *context, int begin, int end) {
+        (*static_cast<Body *>(context))(begin, end);
+    };
+    RunParallelFor(jobs, count, grain, function, &body);
+}
+
+#endif
@@ -0,0 +1,394 @@
+#include "Kernels.h"
+#include <cmath>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_X86 1
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// Scalar
+void MoveBounceScalar(float *x, float *y, float *vx, float *vy, const float *radius,
+                      int count, float dt, float width, float height)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+
+        // Bouncing on Walls
+        if (x[i] <= radius[i] || x[i] >= width - radius[i])
+        {
+            vx[i] = -vx[i];
+        }
+        if (y[i] >= height - radius[i] || y[i] <= radius[i])
+        {
+            vy[i] = -vy[i];
+        }
+    }
+}
+void MoveCullScalar(float *x, float *y, const float *vx, const float *vy, unsigned char *active,
+                    int count, float dt, float width, float height)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+
+        // Deactivate if out of bounds
+        if (y[i] < 0 || y[i] > height || x[i] < 0 || x[i] > width)
+        {
+            active[i] = 0;
+        }
+    }
+}
+
+// Keeps the earlier of hit and a candidate touched at time. Hits are ordered
+// by time, then entity index, so lanes can be visited in any order.
+inline void KeepEarlierHit(SweptHit &hit, int entity, float time)
+{
+    if (time < hit.time || (time == hit.time && (hit.entity < 0 || entity < hit.entity)))
+    {
+        hit.entity = entity;
+        hit.time = time;
+    }
+}
+// Solves the time of impact of circle against entity j. Only touched lanes
+// of the SIMD versions get here, so the square root and division are paid
+// for hits alone.
+inline void TestSweptCandidate(const float *x, const float *y, const float *startX, const float *startY,
+                               const float *radius, int j, const SweptCircle &circle, SweptHit &hit)
+{
+    // Where the circle ends and starts relative to the entity, and how far
+    // that moves over the tick
+    float ex = circle.x - x[j];
+    float ey = circle.y - y[j];
+    float sx = circle.x - circle.dx - startX[j];
+    float sy = circle.y - circle.dy - startY[j];
+    float mx = ex - sx;
+    float my = ey - sy;
+    float r = circle.radius + radius[j];
+    float rr = r * r;
+
+    // Squared distance minus rr over the tick is a t^2 + 2 b t + c. It drops
+    // to zero in [0, 1] if it starts or ends there, or if it is falling at
+    // the start and its minimum, reached by t = 1, is not above zero.
+    float a = mx * mx + my * my;
+    float b = sx * mx + sy * my;
+    float c = sx * sx + sy * sy - rr;
+    float end = ex * ex + ey * ey - rr;
+    float disc = b * b - a * c;
+    bool started = c <= 0.0f;
+    bool approaching = b < 0.0f && disc >= 0.0f;
+    if (!started && !(end <= 0.0f) && !(approaching && -b <= a))
+    {
+        return;
+    }
+
+    float time = 0.0f;
+    if (!started)
+    {
+        // Smaller root, written so it does not cancel
+        float t = approaching ? c / (std::sqrt(disc) - b) : 1.0f;
+        time = t < 1.0f ? t : 1.0f;
+    }
+    KeepEarlierHit(hit, j, time);
+}
+void SweptHitScalar(const float *x, const float *y, const float *startX, const float *startY, const float *radius,
+                    const int *candidates, int count, const SweptCircle &circle, SweptHit &hit)
+{
+    for (int k = 0; k < count; ++k)
+    {
+        TestSweptCandidate(x, y, startX, startY, radius, candidates[k], circle, hit);
+    }
+}
+
+#ifdef KERNELS_X86
+// SSE2, four entities per iteration
+TARGET_SSE2 void MoveBounceSse2(float *x, float *y, float *vx, float *vy, const float *radius,
+                                int count, float dt, float width, float height)
+{
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vwidth = _mm_set1_ps(width);
+    const __m128 vheight = _mm_set1_ps(height);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 sx = _mm_loadu_ps(vx + i);
+        __m128 sy = _mm_loadu_ps(vy + i);
+        __m128 r = _mm_loadu_ps(radius + i);
+
+        px = _mm_add_ps(px, _mm_mul_ps(sx, vdt));
+        py = _mm_add_ps(py, _mm_mul_ps(sy, vdt));
+
+        // Flip the sign bit of the speed where a wall is touched
+        __m128 hitX = _mm_or_ps(_mm_cmple_ps(px, r), _mm_cmpge_ps(px, _mm_sub_ps(vwidth, r)));
+        __m128 hitY = _mm_or_ps(_mm_cmple_ps(py, r), _mm_cmpge_ps(py, _mm_sub_ps(vheight, r)));
+        sx = _mm_xor_ps(sx, _mm_and_ps(hitX, sign));
+        sy = _mm_xor_ps(sy, _mm_and_ps(hitY, sign));
+
+        _mm_storeu_ps(x + i, px);
+        _mm_storeu_ps(y + i, py);
+        _mm_storeu_ps(vx + i, sx);
+        _mm_storeu_ps(vy + i, sy);
+    }
+
+    MoveBounceScalar(x + i, y + i, vx + i, vy + i, radius + i, count - i, dt, width, height);
+}
+TARGET_SSE2 void MoveCullSse2(float *x, float *y, const float *vx, const float *vy, unsigned char *active,
+                              int count, float dt, float width, float height)
+{
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vwidth = _mm_set1_ps(width);
+    const __m128 vheight = _mm_set1_ps(height);
+    const __m128 zero = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 px = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(_mm_loadu_ps(vx + i), vdt));
+        __m128 py = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(vy + i), vdt));
+        _mm_storeu_ps(x + i, px);
+        _mm_storeu_ps(y + i, py);
+
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(px, zero), _mm_cmple_ps(px, vwidth)),
+                                   _mm_and_ps(_mm_cmpge_ps(py, zero), _mm_cmple_ps(py, vheight)));
+        int bits = _mm_movemask_ps(inside);
+        if (bits != 0xF)
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                active[i + lane] &= (unsigned char)((bits >> lane) & 1);
+            }
+        }
+    }
+
+    MoveCullScalar(x + i, y + i, vx + i, vy + i, active + i, count - i, dt, width, height);
+}
+
+// SSE2 has no gather, so candidates are loaded one lane at a time
+TARGET_SSE2 inline __m128 GatherSse2(const float *values, const int *index)
+{
+    return _mm_setr_ps(values[index[0]], values[index[1]], values[index[2]], values[index[3]]);
+}
+TARGET_SSE2 void SweptHitSse2(const float *x, const float *y, const float *startX, const float *startY,
+                              const float *radius, const int *candidates, int count, const SweptCircle &circle,
+                              SweptHit &hit)
+{
+    const __m128 cx = _mm_set1_ps(circle.x);
+    const __m128 cy = _mm_set1_ps(circle.y);
+    const __m128 csx = _mm_set1_ps(circle.x - circle.dx);
+    const __m128 csy = _mm_set1_ps(circle.y - circle.dy);
+    const __m128 cradius = _mm_set1_ps(circle.radius);
+    const __m128 zero = _mm_setzero_ps();
+
+    int k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        const int *index = candidates + k;
+        __m128 ex = _mm_sub_ps(cx, GatherSse2(x, index));
+        __m128 ey = _mm_sub_ps(cy, GatherSse2(y, index));
+        __m128 sx = _mm_sub_ps(csx, GatherSse2(startX, index));
+        __m128 sy = _mm_sub_ps(csy, GatherSse2(startY, index));
+        __m128 mx = _mm_sub_ps(ex, sx);
+        __m128 my = _mm_sub_ps(ey, sy);
+        __m128 r = _mm_add_ps(cradius, GatherSse2(radius, index));
+        __m128 rr = _mm_mul_ps(r, r);
+
+        __m128 a = _mm_add_ps(_mm_mul_ps(mx, mx), _mm_mul_ps(my, my));
+        __m128 b = _mm_add_ps(_mm_mul_ps(sx, mx), _mm_mul_ps(sy, my));
+        __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy)), rr);
+        __m128 end = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), rr);
+        __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+
+        // Same tests as TestSweptCandidate, which takes the touched lanes
+        __m128 approaching = _mm_and_ps(_mm_cmplt_ps(b, zero), _mm_cmpge_ps(disc, zero));
+        __m128 reached = _mm_and_ps(approaching, _mm_cmple_ps(_mm_sub_ps(zero, b), a));
+        __m128 touched = _mm_or_ps(_mm_or_ps(_mm_cmple_ps(c, zero), _mm_cmple_ps(end, zero)), reached);
+        int bits = _mm_movemask_ps(touched);
+        for (int lane = 0; bits != 0; ++lane, bits >>= 1)
+        {
+            if (bits & 1)
+            {
+                TestSweptCandidate(x, y, startX, startY, radius, index[lane], circle, hit);
+            }
+        }
+    }
+
+    SweptHitScalar(x, y, startX, startY, radius, candidates + k, count - k, circle, hit);
+}
+
+// AVX2, eight entities per iteration
+TARGET_AVX2 void MoveBounceAvx2(float *x, float *y, float *vx, float *vy, const float *radius,
+                                int count, float dt, float width, float height)
+{
+    const __m256 vdt = _mm256_set1_ps(dt);
+    const __m256 vwidth = _mm256_set1_ps(width);
+    const __m256 vheight = _mm256_set1_ps(height);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 sx = _mm256_loadu_ps(vx + i);
+        __m256 sy = _mm256_loadu_ps(vy + i);
+        __m256 r = _mm256_loadu_ps(radius + i);
+
+        px = _mm256_add_ps(px, _mm256_mul_ps(sx, vdt));
+        py = _mm256_add_ps(py, _mm256_mul_ps(sy, vdt));
+
+        // Flip the sign bit of the speed where a wall is touched
+        __m256 hitX = _mm256_or_ps(_mm256_cmp_ps(px, r, _CMP_LE_OQ),
+                                   _mm256_cmp_ps(px, _mm256_sub_ps(vwidth, r), _CMP_GE_OQ));
+        __m256 hitY = _mm256_or_ps(_mm256_cmp_ps(py, r, _CMP_LE_OQ),
+                                   _mm256_cmp_ps(py, _mm256_sub_ps(vheight, r), _CMP_GE_OQ));
+        sx = _mm256_xor_ps(sx, _mm256_and_ps(hitX, sign));
+        sy = _mm256_xor_ps(sy, _mm256_and_ps(hitY, sign));
+
+        _mm256_storeu_ps(x + i, px);
+        _mm256_storeu_ps(y + i, py);
+        _mm256_storeu_ps(vx + i, sx);
+        _mm256_storeu_ps(vy + i, sy);
+    }
+
+    // Leave no dirty upper halves for the SSE code that runs next
+    _mm256_zeroupper();
+    MoveBounceScalar(x + i, y + i, vx + i, vy + i, radius + i, count - i, dt, width, height);
+}
+TARGET_AVX2 void MoveCullAvx2(float *x, float *y, const float *vx, const float *vy, unsigned char *active,
+                              int count, float dt, float width, float height)
+{
+    const __m256 vdt = _mm256_set1_ps(dt);
+    const __m256 vwidth = _mm256_set1_ps(width);
+    const __m256 vheight = _mm256_set1_ps(height);
+    const __m256 zero = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 px = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), vdt));
+        __m256 py = _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(vy + i), vdt));
+        _mm256_storeu_ps(x + i, px);
+        _mm256_storeu_ps(y + i, py);
+
+        __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(px, zero, _CMP_GE_OQ), _mm256_cmp_ps(px, vwidth, _CMP_LE_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(py, zero, _CMP_GE_OQ), _mm256_cmp_ps(py, vheight, _CMP_LE_OQ)));
+        int bits = _mm256_movemask_ps(inside);
+        if (bits != 0xFF)
+        {
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                active[i + lane] &= (unsigned char)((bits >> lane) & 1);
+            }
+        }
+    }
+
+    _mm256_zeroupper();
+    MoveCullScalar(x + i, y + i, vx + i, vy + i, active + i, count - i, dt, width, height);
+}
+TARGET_AVX2 void SweptHitAvx2(const float *x, const float *y, const float *startX, const float *startY,
+                              const float *radius, const int *candidates, int count, const SweptCircle &circle,
+                              SweptHit &hit)
+{
+    const __m256 cx = _mm256_set1_ps(circle.x);
+    const __m256 cy = _mm256_set1_ps(circle.y);
+    const __m256 csx = _mm256_set1_ps(circle.x - circle.dx);
+    const __m256 csy = _mm256_set1_ps(circle.y - circle.dy);
+    const __m256 cradius = _mm256_set1_ps(circle.radius);
+    const __m256 zero = _mm256_setzero_ps();
+
+    int k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        const int *index = candidates + k;
+        __m256i lanes = _mm256_loadu_si256((const __m256i *)index);
+        __m256 ex = _mm256_sub_ps(cx, _mm256_i32gather_ps(x, lanes, 4));
+        __m256 ey = _mm256_sub_ps(cy, _mm256_i32gather_ps(y, lanes, 4));
+        __m256 sx = _mm256_sub_ps(csx, _mm256_i32gather_ps(startX, lanes, 4));
+        __m256 sy = _mm256_sub_ps(csy, _mm256_i32gather_ps(startY, lanes, 4));
+        __m256 mx = _mm256_sub_ps(ex, sx);
+        __m256 my = _mm256_sub_ps(ey, sy);
+        __m256 r = _mm256_add_ps(cradius, _mm256_i32gather_ps(radius, lanes, 4));
+        __m256 rr = _mm256_mul_ps(r, r);
+
+        __m256 a = _mm256_add_ps(_mm256_mul_ps(mx, mx), _mm256_mul_ps(my, my));
+        __m256 b = _mm256_add_ps(_mm256_mul_ps(sx, mx), _mm256_mul_ps(sy, my));
+        __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(sx, sx), _mm256_mul_ps(sy, sy)), rr);
+        __m256 end = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey)), rr);
+        __m256 disc = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c));
+
+        // Same tests as TestSweptCandidate, which takes the touched lanes
+        __m256 approaching = _mm256_and_ps(_mm256_cmp_ps(b, zero, _CMP_LT_OQ), _mm256_cmp_ps(disc, zero, _CMP_GE_OQ));
+        __m256 reached = _mm256_and_ps(approaching, _mm256_cmp_ps(_mm256_sub_ps(zero, b), a, _CMP_LE_OQ));
+        __m256 touched = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(c, zero, _CMP_LE_OQ), _mm256_cmp_ps(end, zero, _CMP_LE_OQ)),
+                                      reached);
+        int bits = _mm256_movemask_ps(touched);
+        for (int lane = 0; bits != 0; ++lane, bits >>= 1)
+        {
+            if (bits & 1)
+            {
+                TestSweptCandidate(x, y, startX, startY, radius, index[lane], circle, hit);
+            }
+        }
+    }
+
+    _mm256_zeroupper();
+    SweptHitScalar(x, y, startX, startY, radius, candidates + k, count - k, circle, hit);
+}
+#endif
+
+// Dispatch
+const EntityKernels scalarKernels = {"scalar", MoveBounceScalar, MoveCullScalar, SweptHitScalar};
+#ifdef KERNELS_X86
+const EntityKernels sse2Kernels = {"sse2", MoveBounceSse2, MoveCullSse2, SweptHitSse2};
+const EntityKernels avx2Kernels = {"avx2", MoveBounceAvx2, MoveCullAvx2, SweptHitAvx2};
+#endif
+
+const EntityKernels *FindEntityKernels(const char *name)
+{
+    if (std::strcmp(name, "scalar") == 0)
+    {
+        return &scalarKernels;
+    }
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (std::strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2"))
+    {
+        return &sse2Kernels;
+    }
+    if (std::strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2"))
+    {
+        return &avx2Kernels;
+    }
+#endif
+    return nullptr;
+}
+
+const EntityKernels *SelectEntityKernels()
+{
+    const char *preferred[] = {"avx2", "sse2"};
+    for (const char *name : preferred)
+    {
+        const EntityKernels *kernels = FindEntityKernels(name);
+        if (kernels)
+        {
+            return kernels;
+        }
+    }
+    return &scalarKernels;
+}
+
+const EntityKernels &GetEntityKernels()
+{
+    static const EntityKernels *best = SelectEntityKernels();
+    return *best;
+}
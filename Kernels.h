@@ -0,0 +1,59 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+// Integration and collision kernels over structure-of-arrays entities. Each
+// kernel has a scalar, SSE2 and AVX2 version; the best one the CPU supports is
+// picked once at runtime. All versions give bit-identical results.
+
+// Moves entities by their speed and reflects the speed of any entity touching
+// a wall, the same way enemies bounce
+typedef void (*MoveBounceKernel)(float *x, float *y, float *vx, float *vy, const float *radius,
+                                 int count, float dt, float width, float height);
+
+// Moves entities by their speed and clears active for any entity that left
+// the [0, width] x [0, height] area, the same way bullets are culled
+typedef void (*MoveCullKernel)(float *x, float *y, const float *vx, const float *vy, unsigned char *active,
+                               int count, float dt, float width, float height);
+
+// A circle that ends the tick at (x, y) after moving by (dx, dy)
+struct SweptCircle
+{
+    float x;
+    float y;
+    float dx;
+    float dy;
+    float radius;
+};
+
+// Entity a swept circle touches first, and the fraction of the tick at which
+// it does. Start from {-1, 1.0f}.
+struct SweptHit
+{
+    int entity;
+    float time;
+};
+
+// Swept circle test of circle against the entities listed in candidates, each
+// of which moves in a straight line from (startX, startY) to (x, y) over the
+// tick. Solves for the time of impact of the relative motion, so nothing is
+// missed however far either side moves in a tick. Updates hit with any
+// candidate touched earlier, ties going to the lower entity index.
+typedef void (*SweptHitKernel)(const float *x, const float *y, const float *startX, const float *startY,
+                               const float *radius, const int *candidates, int count, const SweptCircle &circle,
+                               SweptHit &hit);
+
+struct EntityKernels
+{
+    const char *name;
+    MoveBounceKernel moveBounce;
+    MoveCullKernel moveCull;
+    SweptHitKernel sweptHit;
+};
+
+// Best kernels for this CPU
+const EntityKernels &GetEntityKernels();
+
+// Kernels by name ("scalar", "sse2", "avx2"), or nullptr if unsupported here
+const EntityKernels *FindEntityKernels(const char *name);
+
+#endif
@@ -1,403 +1,302 @@
 #include "raylib.h"
-#include "raymath.h"
-#include <chrono>
-
-// Global or player-specific timer
-std::chrono::steady_clock::time_point lastCollisionTime = std::chrono::steady_clock::now();
-
-struct Player
+#include "CircleBatch.h"
+#include "Hud.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
+#include "Replay.h"
+#include "SimThread.h"
+#include <cstring>
+#include <ctime>
+
+// Time from reading input to presenting the first frame drawn from a tick
+// that ran on it
+struct LatencyStats
 {
-    Vector2 position;
-    Vector2 speed;
-    float radius;
-    Color color;
-    int hp;
-    int lvl;
-    int exp;
+    long long lastTick;
+    double latest; // seconds
+    double average;
+    double worst;
+    long samples;
 };
 
-struct Enemy
+// HUD widgets, bound to the values of the frame on screen
+struct GameHud
 {
-    Vector2 position;
-    float radius;
-    Color color;
-    Vector2 speed;
-    bool isActive;
-};
-
-struct Bullet
-{
-    Vector2 position;
-    Vector2 speed;
-    int radius;
-    Color color;
-    bool active;
+    HudLayer layer;
+    int level;
+    int experience;
+    int hp;
+    int stage;
+    int gameOver;
+    int restart;
 };
 
-// Window dimensions
-const int screenWidth{1800};
-const int screenHeight{900};
-
-// Main functions
-void UpdatePlayer(Player &player, Bullet bullets[], int maxBullets, float dashDistance);
-void UpdateBullets(Bullet bullets[], int maxBullets);
-void DrawBullets(const Bullet bullets[], int maxBullets, int bulletRadius);
-void SpawnBullets(Bullet bullets[], int maxBullets, float &bulletTimer, float bulletInterval, Player player);
-void PlayerDash(Player &player, float distance, Vector2 dashDirection);
-void DrawEnemies(Enemy enemies[], int maxEnemies);
-void InitiateEnemies(Enemy enemies[], int maxEnemies);
-void DrawPlayer(Player &player);
-void UpdateEnemies(Enemy enemies[], int maxEnemies, Player &player, Bullet bullets[], int maxBullets);
-bool CheckBulletEnemyCollision(const Bullet &bullet, const Enemy &enemy);
-void HandleBulletEnemyCollision(Bullet &bullet, Enemy &enemy);
-void TriggerBulletEnemyCollision(Player &player, Bullet bullets[], Enemy enemies[], int maxBullets, int maxEnemies);
-void HandleExp(Player &player);
-bool CheckPlayerEnemyCollision(Player &player, const Enemy &enemy);
-void TriggerPlayerEnemyCollision(Player &player, Enemy enemies[], size_t enemyCount);
-void HandleEnemyPlayerCollision(Player &player, Enemy enemies[]);
-void ResetGame(Player &player, Enemy enemies[], int maxEnemies, Bullet bullets[], int maxBullets, int &currentLevel);
+// Render functions
+InputFrame ReadInput();
+float FrameBlend(const RenderFrame &frame);
+void DrawBullets(CircleBatch &circles, const EntityArrays &bullets, float blend);
+void DrawEnemies(CircleBatch &circles, const EntityArrays &enemies, const std::vector<Vec2> &previous, float blend);
+void DrawPlayer(CircleBatch &circles, const Player &player, Vec2 previous, float blend);
+void InitGameHud(GameHud &hud);
+void UpdateGameHud(GameHud &hud, const RenderFrame &frame);
+void UpdateLatency(LatencyStats &latency, const RenderFrame &frame);
 
 // MAIN
-int main()
+// Usage: game [--replay FILE] [--record FILE]
+int main(int argc, char *argv[])
 {
+    // Replays. Every option is read before the recorder opens, so recording
+    // a replay's playback stores the replay's seed.
+    const char *recordPath = nullptr;
+    const char *replayPath = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--replay") == 0)
+        {
+            replayPath = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--record") == 0)
+        {
+            recordPath = argv[i + 1];
+        }
+    }
+
+    ReplayRecorder recorder = {};
+    ReplayReader reader = {};
+    uint64_t seed = (uint64_t)std::time(nullptr);
+    int enemyCount = maxEnemies;
+    if (replayPath)
+    {
+        if (!OpenReplayReader(reader, replayPath))
+        {
+            TraceLog(LOG_ERROR, "REPLAY: Cannot read '%s'", replayPath);
+            return 1;
+        }
+        seed = reader.header.seed;
+        enemyCount = reader.header.enemyCount;
+    }
+    if (recordPath && !OpenReplayRecorder(recorder, recordPath, {seed, enemyCount, 60}))
+    {
+        TraceLog(LOG_ERROR, "REPLAY: Cannot write '%s'", recordPath);
+        CloseReplayReader(reader);
+        return 1;
+    }
+    bool replaying = replayPath != nullptr;
+
     InitWindow(screenWidth, screenHeight, "Game");
     InitAudioDevice();
 
     // VARIABLES
-    // Player
-    Vector2 playerPos = {screenWidth / 2, screenHeight / 2};
-    Vector2 playerSpeed = {0, 0};
-    float dashDistance = 44.0f;
-
     // Sound
     Sound sound = LoadSound("sounds/level_up.wav");
 
-    // Enemies
-    const int maxEnemies = 30;
-    Enemy enemies[maxEnemies];
-
     // State
     Color backgroundColor = GRAY;
-    int currentLevel = 1;
-
-    // Bullets
-    const int maxBullets = 8;
-    Bullet bullets[maxBullets] = {0};
-    const int bulletRadius = 10;
-    float bulletTimer = 0.0f;
-    float bulletInterval = 0.7f;
-
-    // Initiate player
-    Player player = {
-        playerPos,
-        playerSpeed,
-        20,
-        BLACK,
-        100,
-        1,
-        0};
 
-    // Initiate enemies
-    InitiateEnemies(enemies, maxEnemies);
+    // All circles are drawn in one batch per frame
+    CircleBatch circles;
+    InitCircleBatch(circles);
+
+    // HUD text is only redrawn when what it shows changes
+    static GameHud hud;
+    InitGameHud(hud);
+
+    // Simulation
+    // The simulation ticks on its own thread from here on; this one only
+    // reads input and draws the frames it publishes
+    static World world;
+    InitWorld(world, enemyCount, seed);
+    static SimThread sim;
+    StartSimThread(sim, world, recorder, reader, replaying);
+    LatencyStats latency = {-1};
+
+#ifdef ENABLE_PROFILER
+    // F3 toggles the profiler graphs, F4 dumps a trace
+    ProfilerOverlay profilerOverlay;
+    InitProfilerOverlay(profilerOverlay);
+#endif
 
     // MAIN LOOP
     SetTargetFPS(60);
     while (!WindowShouldClose())
     {
-        BeginDrawing();
-        ClearBackground(backgroundColor);
-
-        // Bullets
-        DrawBullets(bullets, maxBullets, bulletRadius);
-        SpawnBullets(bullets, maxBullets, bulletTimer, bulletInterval, player);
-        UpdateBullets(bullets, maxBullets);
+#ifdef ENABLE_PROFILER
+        UpdateProfilerOverlay(profilerOverlay);
+#endif
+
+        // Holding backspace rewinds
+        PostSimInput(sim, ReadInput(), IsKeyDown(KEY_BACKSPACE));
+        long long diverged = sim.divergedTick.exchange(-1);
+        if (diverged >= 0)
+        {
+            TraceLog(LOG_WARNING, "REPLAY: Diverged at tick %lld", diverged);
+        }
 
-        // Player
-        DrawPlayer(player);
-        HandleExp(player);
-        UpdatePlayer(player, bullets, maxBullets, dashDistance);
+        // Draw the newest tick blended with the one before, one tick behind
+        const RenderFrame &frame = AcquireFrame(sim.frames);
+        float blend = FrameBlend(frame);
+        UpdateGameHud(hud, frame);
 
-        // Enemies
-        DrawEnemies(enemies, maxEnemies);
-        UpdateEnemies(enemies, maxEnemies, player, bullets, maxBullets);
+        BeginDrawing();
+        ClearBackground(backgroundColor);
 
-        // Collisions
-        TriggerBulletEnemyCollision(player, bullets, enemies, maxBullets, maxEnemies);
-        TriggerPlayerEnemyCollision(player, enemies, maxEnemies);
+        ClearCircleBatch(circles);
+        DrawBullets(circles, frame.bullets, blend);
+        DrawPlayer(circles, frame.player, frame.previousPlayer, blend);
+        DrawEnemies(circles, frame.enemies, frame.previousEnemies, blend);
+        DrawCircleBatch(circles);
 
         // Draw UI
-        DrawText(TextFormat("Level: %d", player.lvl), 10, 10, 30, ORANGE);
-        DrawText(TextFormat("Experience: %d", player.exp), 10, 40, 30, ORANGE);
-        DrawText(TextFormat("HP: %d", player.hp), 10, 70, 30, ORANGE);
-        DrawText(TextFormat("Stage: %d", currentLevel), 800, 40, 40, BLACK);
+        DrawHudLayer(hud.layer);
 
-        if (player.hp <= 0)
+#ifdef ENABLE_PROFILER
+        DrawProfilerOverlay(profilerOverlay);
+        if (profilerOverlay.visible)
         {
-            DrawText("GAME OVER", screenWidth / 2 - 150, screenHeight / 2 - 30, 60, RED);
-            DrawText("Press R to Restart", screenWidth / 2 - 200, screenHeight / 2 + 40, 40, DARKGRAY);
-
-            if (IsKeyPressed(KEY_R))
-            {
-                ResetGame(player, enemies, maxEnemies, bullets, maxBullets, currentLevel);
-            }
+            DrawText(TextFormat("input latency %.1f ms  avg %.1f ms  worst %.1f ms  %d fps", latency.latest * 1000.0,
+                                latency.average * 1000.0, latency.worst * 1000.0, GetFPS()),
+                     10, screenHeight - 30, 20, RAYWHITE);
         }
+#endif
 
-        EndDrawing();
+        // Includes waiting for vsync and the frame limiter
+        {
+            PROFILE_SCOPE("EndDrawing");
+            EndDrawing();
+        }
+        UpdateLatency(latency, frame);
     }
 
+    StopSimThread(sim);
+    if (latency.samples > 0)
+    {
+        TraceLog(LOG_INFO, "LATENCY: Input to present %.1f ms on average, %.1f ms at worst", latency.average * 1000.0,
+                 latency.worst * 1000.0);
+    }
+    CloseReplayRecorder(recorder);
+    CloseReplayReader(reader);
+    UnloadCircleBatch(circles);
+    UnloadHudLayer(hud.layer);
     UnloadSound(sound);
     CloseAudioDevice();
     CloseWindow();
 }
 
-// Player
-
-void UpdatePlayer(Player &player, Bullet bullets[], int maxBullets, float dashDistance)
+// Input
+InputFrame ReadInput()
 {
-    Vector2 movementInput = {0, 0};
+    InputFrame input = {0};
 
     if (IsKeyDown(KEY_RIGHT))
     {
-        movementInput.x += 1;
+        input.buttons |= INPUT_RIGHT;
     }
-
     if (IsKeyDown(KEY_LEFT))
     {
-        movementInput.x -= 1;
+        input.buttons |= INPUT_LEFT;
     }
-
     if (IsKeyDown(KEY_DOWN))
     {
-        movementInput.y += 1;
+        input.buttons |= INPUT_DOWN;
     }
-
     if (IsKeyDown(KEY_UP))
     {
-        movementInput.y -= 1;
-    }
-
-    // Dash when space bar is pressed
-    if (IsKeyPressed(KEY_SPACE))
-    {
-        // Use the movement input as the dash direction
-        PlayerDash(player, 50.0f, movementInput);
-    }
-
-    // Normalize the movement input to ensure consistent speed
-    movementInput = Vector2Normalize(movementInput);
-
-    // Update player speed based on the movement input
-    player.speed = Vector2Scale(movementInput, 5); // Adjust speed as needed
-
-    // Update player position based on the speed vector
-    player.position.x += player.speed.x;
-    player.position.y += player.speed.y;
-
-    // Ensure player stays within the screen bounds
-    player.position.x = Clamp(player.position.x, player.radius, screenWidth - player.radius);
-    player.position.y = Clamp(player.position.y, player.radius, screenHeight - player.radius);
-}
-void PlayerDash(Player &player, float dashDistance, Vector2 dashDirection)
-{
-    // Store the current speed for later restoration
-    Vector2 originalSpeed = player.speed;
-
-    // Normalize the dash direction to ensure consistent dash distance
-    dashDirection = Vector2Normalize(dashDirection);
-
-    // Calculate the dash vector based on the normalized dash direction
-    Vector2 dashVector = Vector2Scale(dashDirection, dashDistance);
-
-    // Apply the dash vector to the player's position
-    player.position = Vector2Add(player.position, dashVector);
-
-    // Restore the original speed
-    player.speed = originalSpeed;
-}
-void DrawPlayer(Player &player)
-{
-    DrawCircleV(player.position, player.radius, player.color);
-}
-void HandleExp(Player &player)
-{
-    if (player.exp == 100)
-    {
-        player.lvl++;
-        player.exp = 0;
+        input.buttons |= INPUT_UP;
     }
-}
-
-// Enemies
-void InitiateEnemies(Enemy enemies[], int maxEnemies)
-{
-    for (int i = 0; i < maxEnemies; ++i)
+    if (IsKeyDown(KEY_SPACE) || IsKeyPressed(KEY_SPACE))
     {
-        enemies[i].position = {GetRandomValue(0, screenWidth), GetRandomValue(0, screenHeight)};
-        enemies[i].radius = 30;
-        enemies[i].color = {GetRandomValue(0, 255), GetRandomValue(0, 255), GetRandomValue(0, 255), 255};
-        enemies[i].speed = {GetRandomValue(-4, 4),
-                            GetRandomValue(-4, 4)};
+        input.buttons |= INPUT_DASH;
     }
-}
-void DrawEnemies(Enemy enemies[], int maxEnemies)
-{
-    for (int i = 0; i < maxEnemies; i++)
+    if (IsKeyDown(KEY_R) || IsKeyPressed(KEY_R))
     {
-        DrawCircleV(enemies[i].position, enemies[i].radius, enemies[i].color);
+        input.buttons |= INPUT_RESTART;
     }
-}
-void UpdateEnemies(Enemy enemies[], int maxEnemies, Player &player, Bullet bullets[], int maxBullets)
-{
-    int activeEnemies = 0;
 
-    // Enemy movement
-    for (int i = 0; i < maxEnemies; i++)
-    {
-        activeEnemies++;
-        enemies[i].position.x += enemies[i].speed.x;
-        enemies[i].position.y += enemies[i].speed.y;
-
-        // Bouncing on Walls
-        if (enemies[i].position.x <= 0 + enemies[i].radius || enemies[i].position.x >= screenWidth - enemies[i].radius)
-        {
-            enemies[i].speed.x *= -1;
-        }
-        if (enemies[i].position.y >= screenHeight - enemies[i].radius || enemies[i].position.y <= 0 + enemies[i].radius)
-        {
-            enemies[i].speed.y *= -1;
-        }
-    }
+    return input;
 }
 
-// Collisions
-bool CheckBulletEnemyCollision(const Bullet &bullet, const Enemy &enemy)
+// Drawing
+Color ToColor(Rgba color)
 {
-    return (CheckCollisionCircles(bullet.position, bullet.radius, enemy.position, enemy.radius));
+    return {color.r, color.g, color.b, color.a};
 }
-void HandleBulletEnemyCollision(Bullet &bullet, Enemy &enemy)
+float Blend(float previous, float current, float blend)
 {
-    bullet.active = false;
-    enemy.position.x = -100;
+    return previous + (current - previous) * blend;
 }
-void TriggerBulletEnemyCollision(Player &player, Bullet bullets[], Enemy enemies[], int maxBullets, int maxEnemies)
+// How far to blend from the frame's previous tick to its own: 0 as it is
+// published, reaching 1 a tick later, where it holds if the next one is late
+float FrameBlend(const RenderFrame &frame)
 {
-    for (int i = 0; i < maxBullets; ++i)
-    {
-        if (bullets[i].active)
-        {
-            for (int j = 0; j < maxEnemies; ++j)
-            {
-                if (CheckBulletEnemyCollision(bullets[i], enemies[j]))
-                {
-                    HandleBulletEnemyCollision(bullets[i], enemies[j]);
-                    player.exp += 10;
-                }
-            }
-        }
-    }
+    float since = std::chrono::duration<float>(std::chrono::steady_clock::now() - frame.publishTime).count();
+    return ClampFloat(since / simDt, 0.0f, 1.0f);
 }
-bool CheckPlayerEnemyCollision(Player &player, const Enemy &enemy)
+void DrawPlayer(CircleBatch &circles, const Player &player, Vec2 previous, float blend)
 {
-    return (CheckCollisionCircles(player.position, player.radius, enemy.position, enemy.radius));
+    PROFILE_SCOPE("DrawPlayer");
+    AddCircle(circles, Blend(previous.x, player.position.x, blend), Blend(previous.y, player.position.y, blend),
+              player.radius, ToColor(player.color));
 }
-void TriggerPlayerEnemyCollision(Player &player, Enemy enemies[], size_t enemyCount)
+void DrawEnemies(CircleBatch &circles, const EntityArrays &enemies, const std::vector<Vec2> &previous, float blend)
 {
-    auto currentTime = std::chrono::steady_clock::now();
-    auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastCollisionTime).count();
-
-    if (elapsedTime >= 1000) // 1000 ms = 1 second
+    PROFILE_SCOPE("DrawEnemies");
+    for (int i = 0; i < enemies.count; i++)
     {
-        for (size_t i = 0; i < enemyCount; ++i)
+        // Enemies still spawning are see-through
+        Color color = ToColor(enemies.color[i]);
+        if (enemies.active[i] == ENEMY_SPAWNING)
         {
-            if (CheckPlayerEnemyCollision(player, enemies[i]))
-            {
-                HandleEnemyPlayerCollision(player, enemies);
-
-                // Update the last collision time
-                lastCollisionTime = currentTime;
-                break; // Exit after handling one collision
-            }
+            color.a = 90;
         }
+        AddCircle(circles, Blend(previous[i].x, enemies.x[i], blend), Blend(previous[i].y, enemies.y[i], blend),
+                  enemies.radius[i], color);
     }
 }
-
-void HandleEnemyPlayerCollision(Player &player, Enemy enemies[])
+void DrawBullets(CircleBatch &circles, const EntityArrays &bullets, float blend)
 {
-    player.hp -= 50;
-    if (player.hp <= 0)
+    PROFILE_SCOPE("DrawBullets");
+    // Bullets fly straight, so a tick ago they were one step back
+    float back = (1.0f - blend) * simDt;
+    for (int i = 0; i < bullets.count; ++i)
     {
-        player.hp = 0;
+        AddCircle(circles, bullets.x[i] - bullets.vx[i] * back, bullets.y[i] - bullets.vy[i] * back, bullets.radius[i],
+                  ToColor(bullets.color[i]));
     }
 }
-// Bullets
-void UpdateBullets(Bullet bullets[], int maxBullets)
-{
-    for (int i = 0; i < maxBullets; ++i)
-    {
-        if (bullets[i].active)
-        {
-            bullets[i].position.x += bullets[i].speed.x;
-            bullets[i].position.y += bullets[i].speed.y;
 
-            // Deactivate bullet if it goes out of screen bounds
-            if (bullets[i].position.y < 0 || bullets[i].position.y > screenHeight ||
-                bullets[i].position.x < 0 || bullets[i].position.x > screenWidth)
-            {
-                bullets[i].active = false;
-            }
-        }
-    }
-}
-void DrawBullets(const Bullet bullets[], int maxBullets, int bulletRadius)
+// HUD
+void InitGameHud(GameHud &hud)
 {
-    for (int i = 0; i < maxBullets; ++i)
-    {
-        if (bullets[i].active)
-        {
-            DrawCircleV(bullets[i].position, bulletRadius, bullets[i].color);
-        }
-    }
+    InitHudLayer(hud.layer);
+    hud.level = AddHudWidget(hud.layer, "Level: %d", {10, 10}, 30, ORANGE);
+    hud.experience = AddHudWidget(hud.layer, "Experience: %d", {10, 40}, 30, ORANGE);
+    hud.hp = AddHudWidget(hud.layer, "HP: %d", {10, 70}, 30, ORANGE);
+    hud.stage = AddHudWidget(hud.layer, "Stage: %d", {800, 40}, 40, BLACK);
+    hud.gameOver = AddHudWidget(hud.layer, "GAME OVER", {screenWidth / 2 - 150, screenHeight / 2 - 30}, 60, RED);
+    hud.restart = AddHudWidget(hud.layer, "Press R to Restart", {screenWidth / 2 - 200, screenHeight / 2 + 40}, 40, DARKGRAY);
 }
-void SpawnBullets(Bullet bullets[], int maxBullets, float &bulletTimer, float bulletInterval, Player player)
+void UpdateGameHud(GameHud &hud, const RenderFrame &frame)
 {
-    bulletTimer += GetFrameTime();
-    if (bulletTimer >= bulletInterval)
-    {
-        // Initialize bullets with different directions and mark them as active
-        for (int i = 0; i < maxBullets; ++i)
-        {
-            bullets[i].active = true;
-            bullets[i].position = player.position;
-            bullets[i].color = DARKGRAY; // Adjust bullet color as needed
-
-            // Initialize bullets with different directions
-            bullets[0].speed = {0, -10};   // Up
-            bullets[1].speed = {0, 10};    // Down
-            bullets[2].speed = {-10, 0};   // Left
-            bullets[3].speed = {10, 0};    // Right
-            bullets[4].speed = {10, -10};  // Up/Right
-            bullets[5].speed = {10, 10};   // Down/Right
-            bullets[6].speed = {-10, -10}; // Up/Left
-            bullets[7].speed = {-10, 10};  // Down/Left
-        }
-
-        bulletTimer = 0.0f;
-    }
+    SetHudValue(hud.layer, hud.level, frame.player.lvl);
+    SetHudValue(hud.layer, hud.experience, frame.player.exp);
+    SetHudValue(hud.layer, hud.hp, frame.player.hp);
+    SetHudValue(hud.layer, hud.stage, frame.currentLevel);
+    SetHudVisible(hud.layer, hud.gameOver, frame.player.hp <= 0);
+    SetHudVisible(hud.layer, hud.restart, frame.player.hp <= 0);
+    UpdateHudLayer(hud.layer);
 }
 
-void ResetGame(Player &player, Enemy enemies[], int maxEnemies, Bullet bullets[], int maxBullets, int &currentLevel)
+// Latency
+void UpdateLatency(LatencyStats &latency, const RenderFrame &frame)
 {
-    player.hp = 100;
-    player.exp = 0;
-    player.lvl = 1;
-    player.position = {screenWidth / 2, screenHeight / 2};
-
-    InitiateEnemies(enemies, maxEnemies);
-
-    for (int i = 0; i < maxBullets; ++i)
+    // Only the first present of each tick counts; later ones show nothing new
+    if (frame.tick == latency.lastTick)
     {
-        bullets[i].active = false;
+        return;
     }
-
-    currentLevel = 1;
-}
\ No newline at end of file
+    latency.lastTick = frame.tick;
+    latency.latest = std::chrono::duration<double>(std::chrono::steady_clock::now() - frame.inputTime).count();
+    latency.samples++;
+    latency.average += (latency.latest - latency.average) / latency.samples;
+    latency.worst = latency.latest > latency.worst ? latency.latest : latency.worst;
+}
@@ -0,0 +1,164 @@
+#include "Profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+const int maxProfileThreads = 64;
+
+struct ProfileRing
+{
+    ProfileEvent events[profileRingSize];
+    std::atomic<uint64_t> written; // events ever written, the next slot is written % size
+    int thread;
+};
+
+// Rings are created on a thread's first event and live until exit
+std::atomic<ProfileRing *> profileRings[maxProfileThreads];
+std::atomic<int> profileRingCount(0);
+thread_local ProfileRing *threadRing = nullptr;
+
+const std::chrono::steady_clock::time_point profileEpoch = std::chrono::steady_clock::now();
+
+uint64_t ProfileNow()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profileEpoch).count();
+}
+
+ProfileRing *AcquireThreadRing()
+{
+    int index = profileRingCount.fetch_add(1);
+    if (index >= maxProfileThreads)
+    {
+        return nullptr;
+    }
+
+    ProfileRing *ring = new ProfileRing();
+    ring->written = 0;
+    ring->thread = index;
+    profileRings[index].store(ring, std::memory_order_release);
+    return ring;
+}
+
+void RecordProfileEvent(const char *name, uint64_t start, uint64_t end)
+{
+    if (!threadRing)
+    {
+        threadRing = AcquireThreadRing();
+        if (!threadRing)
+        {
+            return;
+        }
+    }
+
+    uint64_t index = threadRing->written.load(std::memory_order_relaxed);
+    threadRing->events[index % profileRingSize] = {name, start, end, threadRing->thread};
+    threadRing->written.store(index + 1, std::memory_order_release);
+}
+
+// Calls visit(event) for every intact event that ended at or after since.
+// A thread's events are stored in the order they end, so each ring is walked
+// back from the newest event only as far as since
+template <typename Visit>
+void VisitProfileEvents(uint64_t since, Visit visit)
+{
+    int rings = profileRingCount.load();
+    rings = rings < maxProfileThreads ? rings : maxProfileThreads;
+    std::vector<ProfileEvent> copy;
+
+    for (int i = 0; i < rings; ++i)
+    {
+        ProfileRing *ring = profileRings[i].load(std::memory_order_acquire);
+        if (!ring)
+        {
+            continue;
+        }
+
+        uint64_t end = ring->written.load(std::memory_order_acquire);
+        uint64_t begin = end > (uint64_t)profileRingSize ? end - profileRingSize : 0;
+        copy.clear();
+        for (uint64_t index = end; index > begin; --index)
+        {
+            const ProfileEvent &event = ring->events[(index - 1) % profileRingSize];
+            if (event.end < since)
+            {
+                break;
+            }
+            copy.push_back(event);
+        }
+
+        // The owner kept writing while we copied; skip what it overwrote
+        uint64_t after = ring->written.load(std::memory_order_acquire);
+        uint64_t intact = after > (uint64_t)profileRingSize ? after - profileRingSize : 0;
+        for (size_t j = 0; j < copy.size() && end - j > intact; ++j)
+        {
+            visit(copy[j]);
+        }
+    }
+}
+
+void CollectProfileEvents(uint64_t since, std::vector<ProfileEvent> &events)
+{
+    events.clear();
+    VisitProfileEvents(since, [&](const ProfileEvent &event) {
+        if (event.start >= since)
+        {
+            events.push_back(event);
+        }
+    });
+}
+
+void SumProfileScopes(uint64_t since, uint64_t until, const char *const names[], int count, double totalsMs[])
+{
+    for (int i = 0; i < count; ++i)
+    {
+        totalsMs[i] = 0.0;
+    }
+
+    VisitProfileEvents(since, [&](const ProfileEvent &event) {
+        if (event.start < since || event.start >= until)
+        {
+            return;
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            if (event.name == names[i] || std::strcmp(event.name, names[i]) == 0)
+            {
+                totalsMs[i] += (event.end - event.start) / 1e6;
+                break;
+            }
+        }
+    });
+}
+
+bool WriteChromeTrace(const char *path, double lastSeconds)
+{
+    uint64_t now = ProfileNow();
+    uint64_t window = (uint64_t)(lastSeconds * 1e9);
+    std::vector<ProfileEvent> events;
+    CollectProfileEvents(now > window ? now - window : 0, events);
+
+    FILE *file = std::fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+
+    // Complete ("X") events, timestamps in microseconds
+    std::fprintf(file, "{\"traceEvents\": [\n");
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const ProfileEvent &event = events[i];
+        std::fprintf(file, "  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}%s\n",
+                     event.name, event.thread, event.start / 1e3, (event.end - event.start) / 1e3,
+                     i + 1 < events.size() ? "," : "");
+    }
+    std::fprintf(file, "], \"displayTimeUnit\": \"ms\"}\n");
+    std::fclose(file);
+    return true;
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Scoped frame profiler. PROFILE_SCOPE("Name") records when the enclosing
+// scope starts and ends into a ring buffer owned by the running thread; only
+// that thread writes it, so recording takes no locks. Readers copy the rings
+// and drop any entry that was overwritten while they copied it.
+//
+// Everything compiles away unless ENABLE_PROFILER is defined (make
+// PROFILER=TRUE, on by default in debug builds). Scope names must be string
+// literals or otherwise outlive the profiler.
+
+#ifdef ENABLE_PROFILER
+
+#include <cstdint>
+#include <vector>
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+// Events kept per thread, about a minute of a busy frame at 60 fps
+const int profileRingSize = 1 << 16;
+
+struct ProfileEvent
+{
+    const char *name;
+    uint64_t start; // nanoseconds on the profiler clock
+    uint64_t end;
+    int thread;
+};
+
+uint64_t ProfileNow();
+void RecordProfileEvent(const char *name, uint64_t start, uint64_t end);
+
+struct ProfileScope
+{
+    const char *name;
+    uint64_t start;
+
+    explicit ProfileScope(const char *scopeName) : name(scopeName), start(ProfileNow()) {}
+    ~ProfileScope() { RecordProfileEvent(name, start, ProfileNow()); }
+};
+
+// Copies every event that started at or after since, from all threads
+void CollectProfileEvents(uint64_t since, std::vector<ProfileEvent> &events);
+
+// Milliseconds spent in each named scope that started between since and
+// until, summed over all threads
+void SumProfileScopes(uint64_t since, uint64_t until, const char *const names[], int count, double totalsMs[]);
+
+// Writes the last seconds of events as Chrome trace_event JSON, which
+// chrome://tracing and ui.perfetto.dev open
+bool WriteChromeTrace(const char *path, double lastSeconds);
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+
+#endif
+
+#endif
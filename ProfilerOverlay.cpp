@@ -0,0 +1,86 @@
+#include "ProfilerOverlay.h"
+
+#ifdef ENABLE_PROFILER
+
+const char *const overlayScopes[overlayScopeCount] = {
+    "StepWorld",   "UpdateEnemies", "RebuildEnemyGrid", "TriggerBulletEnemyCollision", "TriggerPlayerEnemyCollision",
+    "DrawEnemies", "DrawBullets",   "DrawCircleBatch",  "HUD",                         "EndDrawing"};
+
+const Color overlayColors[overlayScopeCount] = {RED, ORANGE, GOLD, LIME, GREEN, SKYBLUE, BLUE, PURPLE, VIOLET, BEIGE};
+
+void InitProfilerOverlay(ProfilerOverlay &overlay)
+{
+    overlay = ProfilerOverlay{};
+    overlay.frameStart = ProfileNow();
+}
+
+void UpdateProfilerOverlay(ProfilerOverlay &overlay)
+{
+    if (IsKeyPressed(KEY_F3))
+    {
+        overlay.visible = !overlay.visible;
+    }
+    if (IsKeyPressed(KEY_F4))
+    {
+        if (WriteChromeTrace("trace.json", traceSeconds))
+        {
+            TraceLog(LOG_INFO, "PROFILER: Wrote last %.0f seconds to trace.json", traceSeconds);
+        }
+        else
+        {
+            TraceLog(LOG_WARNING, "PROFILER: Could not write trace.json");
+        }
+    }
+
+    // Only pay for summing while the graphs are on screen
+    uint64_t now = ProfileNow();
+    if (overlay.visible)
+    {
+        double totals[overlayScopeCount];
+        SumProfileScopes(overlay.frameStart, now, overlayScopes, overlayScopeCount, totals);
+        for (int i = 0; i < overlayScopeCount; ++i)
+        {
+            overlay.history[i][overlay.frame] = (float)totals[i];
+        }
+        overlay.frame = (overlay.frame + 1) % overlayFrames;
+    }
+    overlay.frameStart = now;
+}
+
+void DrawProfilerOverlay(const ProfilerOverlay &overlay)
+{
+    if (!overlay.visible)
+    {
+        return;
+    }
+
+    // One row per scope: name, latest and peak time, and a bar per frame
+    // scaled so the 60 fps budget fills the row
+    const int left = 10;
+    const int top = 110;
+    const int rowHeight = 40;
+    const int labelWidth = 330;
+    const float budgetMs = 1000.0f / 60.0f;
+
+    DrawRectangle(left, top, labelWidth + overlayFrames * 2 + 10, overlayScopeCount * rowHeight + 10, Fade(BLACK, 0.7f));
+    for (int i = 0; i < overlayScopeCount; ++i)
+    {
+        int y = top + 5 + i * rowHeight;
+        int last = (overlay.frame + overlayFrames - 1) % overlayFrames;
+        float peak = 0.0f;
+        for (int frame = 0; frame < overlayFrames; ++frame)
+        {
+            float ms = overlay.history[i][(overlay.frame + frame) % overlayFrames];
+            peak = ms > peak ? ms : peak;
+
+            int height = (int)(ms / budgetMs * (rowHeight - 4));
+            height = height < rowHeight - 4 ? height : rowHeight - 4;
+            DrawRectangle(left + labelWidth + frame * 2, y + rowHeight - 4 - height, 2, height, overlayColors[i]);
+        }
+
+        DrawText(overlayScopes[i], left + 5, y + 2, 10, overlayColors[i]);
+        DrawText(TextFormat("%.2f ms  peak %.2f ms", overlay.history[i][last], peak), left + 5, y + 16, 10, RAYWHITE);
+    }
+}
+
+#endif
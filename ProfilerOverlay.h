@@ -0,0 +1,35 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include "Profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include "raylib.h"
+#include <cstdint>
+
+// In-game view of the profiler: F3 toggles rolling per-scope graphs of the
+// last overlayFrames frames, F4 writes the last traceSeconds to trace.json.
+
+const int overlayFrames = 240;
+const int overlayScopeCount = 10;
+const double traceSeconds = 10.0;
+
+struct ProfilerOverlay
+{
+    bool visible;
+    uint64_t frameStart;
+    int frame;                                       // next history slot
+    float history[overlayScopeCount][overlayFrames]; // milliseconds per frame
+};
+
+void InitProfilerOverlay(ProfilerOverlay &overlay);
+
+// Call once per frame before drawing: handles the keys and closes the
+// previous frame's sample
+void UpdateProfilerOverlay(ProfilerOverlay &overlay);
+void DrawProfilerOverlay(const ProfilerOverlay &overlay);
+
+#endif
+
+#endif
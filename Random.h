@@ -0,0 +1,32 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Seeded generator owned by the world (splitmix64), so the same seed and
+// inputs always replay the same run. Its whole state is one integer.
+struct Rng
+{
+    uint64_t state;
+};
+
+inline void SeedRng(Rng &rng, uint64_t seed)
+{
+    rng.state = seed;
+}
+
+inline uint32_t NextRandom(Rng &rng)
+{
+    uint64_t z = (rng.state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+// Random integer in [min, max], like raylib's GetRandomValue
+inline int RandomValue(Rng &rng, int min, int max)
+{
+    return min + (int)(NextRandom(rng) % (uint32_t)(max - min + 1));
+}
+
+#endif
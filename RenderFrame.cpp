@@ -0,0 +1,70 @@
+#include "RenderFrame.h"
+#include "Profiler.h"
+#include <algorithm>
+
+// Copies the live entities, reusing the frame's storage
+void CopyEntities(const EntityArrays &from, EntityArrays &to)
+{
+    int count = from.count;
+    ResizeEntityArrays(to, count);
+    std::copy(from.x.begin(), from.x.begin() + count, to.x.begin());
+    std::copy(from.y.begin(), from.y.begin() + count, to.y.begin());
+    std::copy(from.vx.begin(), from.vx.begin() + count, to.vx.begin());
+    std::copy(from.vy.begin(), from.vy.begin() + count, to.vy.begin());
+    std::copy(from.radius.begin(), from.radius.begin() + count, to.radius.begin());
+    std::copy(from.color.begin(), from.color.begin() + count, to.color.begin());
+    std::copy(from.active.begin(), from.active.begin() + count, to.active.begin());
+}
+
+void CaptureRenderFrame(const World &world, RenderTrail &trail, RenderFrame &frame)
+{
+    PROFILE_SCOPE("CaptureRenderFrame");
+    const EntityArrays &enemies = world.enemies;
+    const EntityHandles &handles = world.enemyHandles;
+
+    frame.tick = world.tick;
+    frame.player = world.player;
+    frame.previousPlayer = trail.started ? trail.player : world.player.position;
+    frame.currentLevel = world.currentLevel;
+    CopyEntities(enemies, frame.enemies);
+    CopyEntities(world.bullets, frame.bullets);
+
+    // An enemy's slot and generation only match the trail if it is the same
+    // enemy as last tick; new ones start where they are
+    trail.positions.resize(handles.denseOf.size());
+    trail.generations.resize(handles.denseOf.size(), 0);
+    frame.previousEnemies.resize(enemies.count);
+    for (int i = 0; i < enemies.count; ++i)
+    {
+        uint32_t slot = handles.slotOf[i];
+        Vec2 position = {enemies.x[i], enemies.y[i]};
+        bool known = trail.generations[slot] == handles.generation[slot];
+        frame.previousEnemies[i] = known ? trail.positions[slot] : position;
+        trail.positions[slot] = position;
+        trail.generations[slot] = handles.generation[slot];
+    }
+    trail.player = world.player.position;
+    trail.started = true;
+}
+
+void InitFrameExchange(FrameExchange &exchange)
+{
+    exchange.back = 0;
+    exchange.middle.store(1, std::memory_order_relaxed);
+    exchange.front = 2;
+}
+
+void PublishFrame(FrameExchange &exchange)
+{
+    // Release makes the frame's contents visible to the acquire below
+    exchange.back = exchange.middle.exchange(exchange.back | frameFresh, std::memory_order_acq_rel) & ~frameFresh;
+}
+
+const RenderFrame &AcquireFrame(FrameExchange &exchange)
+{
+    if (exchange.middle.load(std::memory_order_relaxed) & frameFresh)
+    {
+        exchange.front = exchange.middle.exchange(exchange.front, std::memory_order_acq_rel) & ~frameFresh;
+    }
+    return exchange.frames[exchange.front];
+}
@@ -0,0 +1,72 @@
+#ifndef RENDER_FRAME_H
+#define RENDER_FRAME_H
+
+#include "Simulation.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// What the renderer draws of one tick, copied out of the world so the
+// simulation can go on while it is drawn. Each frame also keeps where the
+// enemies and the player were one tick earlier, so the renderer can blend
+// between the last two ticks from the newest frame alone. Bullets fly
+// straight and are blended back along their speed.
+
+typedef std::chrono::steady_clock::time_point SimClockTime;
+
+struct RenderFrame
+{
+    long long tick;
+    SimClockTime inputTime;   // when the input this tick ran on was read
+    SimClockTime publishTime; // when the frame was handed over
+
+    Player player;
+    Vec2 previousPlayer;
+    int currentLevel;
+
+    EntityArrays enemies;
+    std::vector<Vec2> previousEnemies; // per enemy, its position a tick earlier
+    EntityArrays bullets;
+};
+
+// Positions of the last captured tick by enemy slot, kept by the simulation
+// side to fill in previousEnemies
+struct RenderTrail
+{
+    std::vector<Vec2> positions;
+    std::vector<uint32_t> generations; // 0 when the slot held no enemy
+    Vec2 player;
+    bool started;
+};
+
+void CaptureRenderFrame(const World &world, RenderTrail &trail, RenderFrame &frame);
+
+// Lock-free triple buffer of frames between one writer and one reader. The
+// writer fills its back frame and swaps it with the middle one, the reader
+// swaps its front frame with the middle one when a newer frame is there, so
+// neither ever waits for the other and the reader always gets the newest
+// complete frame.
+const int frameFresh = 4; // set in middle when it holds a frame the reader has not seen
+
+struct FrameExchange
+{
+    RenderFrame frames[3];
+    int back;                // the writer's
+    int front;               // the reader's
+    std::atomic<int> middle; // the other one, plus frameFresh
+};
+
+void InitFrameExchange(FrameExchange &exchange);
+
+inline RenderFrame &BackFrame(FrameExchange &exchange)
+{
+    return exchange.frames[exchange.back];
+}
+
+// Writer: hands the back frame over and takes another one to fill
+void PublishFrame(FrameExchange &exchange);
+// Reader: newest published frame, valid until the next call
+const RenderFrame &AcquireFrame(FrameExchange &exchange);
+
+#endif
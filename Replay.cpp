@@ -0,0 +1,265 @@
+#include "Replay.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const char replayMagic[4] = {'M', 'G', 'R', 'P'};
+const uint32_t replayVersion = 1;
+const size_t replayHeaderSize = 4 + 4 + 8 + 4 + 4;
+
+// Encoding
+void WriteUint(FILE *file, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        std::fputc((int)((value >> (8 * i)) & 0xFF), file);
+    }
+}
+void WriteVarint(FILE *file, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        std::fputc((int)((value & 0x7F) | 0x80), file);
+        value >>= 7;
+    }
+    std::fputc((int)value, file);
+}
+uint64_t ReadUint(const unsigned char *data, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+    {
+        value |= (uint64_t)data[i] << (8 * i);
+    }
+    return value;
+}
+bool ReadVarint(ReplayReader &reader, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && reader.offset < reader.size; shift += 7)
+    {
+        unsigned char byte = reader.data[reader.offset++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Recording
+void FlushRun(ReplayRecorder &recorder)
+{
+    if (recorder.runLength > 0)
+    {
+        WriteVarint(recorder.file, recorder.runLength);
+        std::fputc((int)((recorder.runButtons ^ recorder.previousButtons) & 0xFF), recorder.file);
+        recorder.previousButtons = recorder.runButtons;
+        recorder.runLength = 0;
+    }
+}
+
+bool OpenReplayRecorder(ReplayRecorder &recorder, const char *path, const ReplayHeader &header)
+{
+    recorder = ReplayRecorder{};
+    recorder.file = std::fopen(path, "wb");
+    if (!recorder.file)
+    {
+        return false;
+    }
+    recorder.header = header;
+
+    std::fwrite(replayMagic, 1, sizeof(replayMagic), recorder.file);
+    WriteUint(recorder.file, replayVersion, 4);
+    WriteUint(recorder.file, header.seed, 8);
+    WriteUint(recorder.file, (uint32_t)header.enemyCount, 4);
+    WriteUint(recorder.file, header.checksumInterval, 4);
+    return true;
+}
+
+void RecordTick(ReplayRecorder &recorder, const InputFrame &input, const World &world)
+{
+    if (recorder.runLength > 0 && input.buttons != recorder.runButtons)
+    {
+        FlushRun(recorder);
+    }
+    recorder.runButtons = input.buttons;
+    recorder.runLength++;
+
+    if (recorder.header.checksumInterval > 0 && world.tick % recorder.header.checksumInterval == 0)
+    {
+        FlushRun(recorder);
+        WriteVarint(recorder.file, 0);
+        WriteVarint(recorder.file, (uint64_t)world.tick);
+        WriteUint(recorder.file, ChecksumWorld(world), 8);
+    }
+}
+
+void CloseReplayRecorder(ReplayRecorder &recorder)
+{
+    if (recorder.file)
+    {
+        FlushRun(recorder);
+        std::fclose(recorder.file);
+    }
+    recorder = ReplayRecorder{};
+}
+
+// Playback
+bool MapReplayFile(ReplayReader &reader, const char *path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (!mapping)
+    {
+        return false;
+    }
+    reader.data = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!reader.data)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    reader.size = (size_t)size.QuadPart;
+    reader.mapping = mapping;
+    return true;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+    reader.data = static_cast<const unsigned char *>(data);
+    reader.size = (size_t)info.st_size;
+    return true;
+#endif
+}
+
+bool OpenReplayReader(ReplayReader &reader, const char *path)
+{
+    reader = ReplayReader{};
+    if (!MapReplayFile(reader, path))
+    {
+        return false;
+    }
+
+    if (reader.size < replayHeaderSize || std::memcmp(reader.data, replayMagic, sizeof(replayMagic)) != 0 ||
+        ReadUint(reader.data + 4, 4) != replayVersion)
+    {
+        CloseReplayReader(reader);
+        return false;
+    }
+
+    reader.header.seed = ReadUint(reader.data + 8, 8);
+    reader.header.enemyCount = (int)ReadUint(reader.data + 16, 4);
+    reader.header.checksumInterval = (uint32_t)ReadUint(reader.data + 20, 4);
+    reader.offset = replayHeaderSize;
+    return true;
+}
+
+bool ReadReplayInput(ReplayReader &reader, InputFrame &input)
+{
+    while (reader.runLeft == 0)
+    {
+        uint64_t length;
+        if (!ReadVarint(reader, length))
+        {
+            return false;
+        }
+
+        if (length == 0)
+        {
+            // Checkpoint nobody asked for, skip it
+            uint64_t tick;
+            if (!ReadVarint(reader, tick) || reader.offset + 8 > reader.size)
+            {
+                return false;
+            }
+            reader.offset += 8;
+            continue;
+        }
+
+        if (reader.offset >= reader.size)
+        {
+            return false;
+        }
+        reader.buttons ^= reader.data[reader.offset++];
+        reader.runLeft = (uint32_t)length;
+    }
+
+    reader.runLeft--;
+    input.buttons = reader.buttons;
+    return true;
+}
+
+bool ReadReplayChecksum(ReplayReader &reader, long long tick, uint64_t &checksum)
+{
+    if (reader.runLeft > 0 || reader.offset >= reader.size || reader.data[reader.offset] != 0)
+    {
+        return false;
+    }
+
+    // Peek at the checkpoint and only consume it if it is for this tick
+    size_t start = reader.offset;
+    reader.offset++;
+    uint64_t recordTick;
+    if (!ReadVarint(reader, recordTick) || (long long)recordTick != tick || reader.offset + 8 > reader.size)
+    {
+        reader.offset = start;
+        return false;
+    }
+    checksum = ReadUint(reader.data + reader.offset, 8);
+    reader.offset += 8;
+    return true;
+}
+
+void CloseReplayReader(ReplayReader &reader)
+{
+#ifdef _WIN32
+    if (reader.data)
+    {
+        UnmapViewOfFile(reader.data);
+    }
+    if (reader.mapping)
+    {
+        CloseHandle((HANDLE)reader.mapping);
+    }
+#else
+    if (reader.data)
+    {
+        munmap((void *)reader.data, reader.size);
+    }
+#endif
+    reader = ReplayReader{};
+}
@@ -0,0 +1,61 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "Simulation.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Input recordings. A replay file holds the world's seed and enemy count and
+// the input of every tick, so stepping a fresh world with it reproduces the
+// run exactly. Every checksumInterval ticks it also stores ChecksumWorld, so a
+// replay notices divergence on the first checkpoint after it happens.
+//
+// Layout, little endian:
+//   header  "MGRP", u32 version, u64 seed, i32 enemyCount, u32 checksumInterval
+//   records, each starting with a varint:
+//     n > 0  the next n ticks hold buttons = previous buttons ^ (one byte)
+//     0      checkpoint: varint tick, u64 checksum of the world after that tick
+// Held buttons rarely change, so a long run costs a couple of bytes.
+
+struct ReplayHeader
+{
+    uint64_t seed;
+    int enemyCount;
+    uint32_t checksumInterval;
+};
+
+struct ReplayRecorder
+{
+    FILE *file;
+    ReplayHeader header;
+    unsigned int previousButtons; // buttons before the current run
+    unsigned int runButtons;
+    uint32_t runLength;
+};
+
+// Streams the file through a read-only memory mapping
+struct ReplayReader
+{
+    ReplayHeader header;
+    const unsigned char *data;
+    size_t size;
+    size_t offset;
+    unsigned int buttons;
+    uint32_t runLeft;
+    void *mapping; // platform handle
+};
+
+bool OpenReplayRecorder(ReplayRecorder &recorder, const char *path, const ReplayHeader &header);
+// Call after stepping the world with input
+void RecordTick(ReplayRecorder &recorder, const InputFrame &input, const World &world);
+void CloseReplayRecorder(ReplayRecorder &recorder);
+
+bool OpenReplayReader(ReplayReader &reader, const char *path);
+// Input for the next tick, false at the end of the recording
+bool ReadReplayInput(ReplayReader &reader, InputFrame &input);
+// Checkpoint stored for the given tick, if the next record is one
+bool ReadReplayChecksum(ReplayReader &reader, long long tick, uint64_t &checksum);
+void CloseReplayReader(ReplayReader &reader);
+
+#endif
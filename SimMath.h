@@ -0,0 +1,50 @@
+#ifndef SIM_MATH_H
+#define SIM_MATH_H
+
+#include <cmath>
+
+// Plain math types used by the simulation, so it can run without raylib.
+// They share the memory layout of raylib's Vector2 and Color.
+struct Vec2
+{
+    float x;
+    float y;
+};
+
+struct Rgba
+{
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+};
+
+const Rgba colorBlack{0, 0, 0, 255};
+const Rgba colorDarkGray{80, 80, 80, 255};
+
+inline Vec2 Vec2Add(Vec2 a, Vec2 b)
+{
+    return {a.x + b.x, a.y + b.y};
+}
+
+inline Vec2 Vec2Scale(Vec2 v, float scale)
+{
+    return {v.x * scale, v.y * scale};
+}
+
+inline Vec2 Vec2Normalize(Vec2 v)
+{
+    float length = std::sqrt(v.x * v.x + v.y * v.y);
+    if (length > 0.0f)
+    {
+        return {v.x / length, v.y / length};
+    }
+    return v;
+}
+
+inline float ClampFloat(float value, float min, float max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+#endif
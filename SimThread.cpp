@@ -0,0 +1,139 @@
+#include "SimThread.h"
+#include "Profiler.h"
+
+// Behind by more than this, the thread drops the missed ticks instead of
+// racing through them
+const float maxSimLag = 0.25f;
+
+void RunSimThread(SimThread &sim);
+void RunSimTick(SimThread &sim);
+void PublishWorld(SimThread &sim, SimClockTime inputTime);
+
+void StartSimThread(SimThread &sim, World &world, ReplayRecorder &recorder, ReplayReader &reader, bool replaying)
+{
+    sim.world = &world;
+    sim.recorder = &recorder;
+    sim.reader = &reader;
+    sim.replaying = replaying;
+    sim.heldButtons.store(0);
+    sim.latchedButtons.store(0);
+    sim.inputTime.store(std::chrono::steady_clock::now().time_since_epoch().count());
+    sim.rewinding.store(false);
+    sim.divergedTick.store(-1);
+
+    // Holding rewind goes back through the last ten seconds, except while a
+    // replay is recorded or played back
+    InitSnapshotRing(sim.rewind, world, 10 * (int)simTickRate, (int)simTickRate);
+    PushSnapshot(sim.rewind, world);
+
+    // The renderer has a frame from the start
+    InitFrameExchange(sim.frames);
+    sim.trail = RenderTrail{};
+    PublishWorld(sim, std::chrono::steady_clock::now());
+
+    sim.running.store(true);
+    sim.thread = std::thread(RunSimThread, std::ref(sim));
+}
+
+void StopSimThread(SimThread &sim)
+{
+    sim.running.store(false);
+    if (sim.thread.joinable())
+    {
+        sim.thread.join();
+    }
+}
+
+void PostSimInput(SimThread &sim, const InputFrame &input, bool rewinding)
+{
+    sim.heldButtons.store(input.buttons, std::memory_order_relaxed);
+    sim.latchedButtons.fetch_or(input.buttons, std::memory_order_relaxed);
+    sim.rewinding.store(rewinding, std::memory_order_relaxed);
+    sim.inputTime.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+void RunSimThread(SimThread &sim)
+{
+    // The job system runs its parallel passes from the thread that made it
+    JobSystem *jobs = CreateJobSystem();
+    sim.world->jobs = jobs;
+
+    const std::chrono::steady_clock::duration tick =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(simDt));
+    const std::chrono::steady_clock::duration maxLag =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(maxSimLag));
+
+    // Ticks are due on a fixed schedule; sleeping to each deadline rather than
+    // for a tick's length keeps the rate from drifting
+    SimClockTime next = std::chrono::steady_clock::now();
+    while (sim.running.load(std::memory_order_acquire))
+    {
+        RunSimTick(sim);
+
+        next += tick;
+        SimClockTime now = std::chrono::steady_clock::now();
+        if (now - next > maxLag)
+        {
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+
+    sim.world->jobs = nullptr;
+    DestroyJobSystem(jobs);
+}
+
+void RunSimTick(SimThread &sim)
+{
+    PROFILE_SCOPE("SimTick");
+    World &world = *sim.world;
+
+    // Buttons held now, plus any pressed and released since the last tick
+    InputFrame input = {sim.heldButtons.load(std::memory_order_relaxed) |
+                        sim.latchedButtons.exchange(0, std::memory_order_relaxed)};
+    SimClockTime inputTime = SimClockTime(SimClockTime::duration(sim.inputTime.load(std::memory_order_relaxed)));
+
+    if (sim.rewinding.load(std::memory_order_relaxed) && !sim.replaying && !sim.recorder->file)
+    {
+        long long previous = world.tick - 1;
+        if (previous >= OldestSnapshotTick(sim.rewind) && RestoreSnapshot(sim.rewind, previous, world))
+        {
+            TruncateSnapshots(sim.rewind, previous);
+        }
+        PublishWorld(sim, inputTime);
+        return;
+    }
+
+    // A finished replay hands control back to the keyboard
+    InputFrame tickInput = input;
+    if (sim.replaying && !ReadReplayInput(*sim.reader, tickInput))
+    {
+        sim.replaying = false;
+        tickInput = input;
+    }
+
+    StepWorld(world, simDt, tickInput);
+    PushSnapshot(sim.rewind, world);
+    if (sim.recorder->file)
+    {
+        RecordTick(*sim.recorder, tickInput, world);
+    }
+
+    uint64_t expected;
+    if (sim.replaying && ReadReplayChecksum(*sim.reader, world.tick, expected) && expected != ChecksumWorld(world))
+    {
+        sim.divergedTick.store(world.tick);
+        sim.replaying = false;
+    }
+
+    PublishWorld(sim, inputTime);
+}
+
+void PublishWorld(SimThread &sim, SimClockTime inputTime)
+{
+    RenderFrame &frame = BackFrame(sim.frames);
+    CaptureRenderFrame(*sim.world, sim.trail, frame);
+    frame.inputTime = inputTime;
+    frame.publishTime = std::chrono::steady_clock::now();
+    PublishFrame(sim.frames);
+}
@@ -0,0 +1,52 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include "RenderFrame.h"
+#include "Replay.h"
+#include "Simulation.h"
+#include "Snapshot.h"
+#include <atomic>
+#include <thread>
+
+// Runs the game's simulation on its own thread at simTickRate, so a slow
+// frame or a vsync stall never slows gameplay and a slow tick never holds up
+// drawing. The render thread posts input through atomics and takes each tick
+// as a RenderFrame through a triple buffer; nothing else is shared.
+//
+// The thread owns the world while it runs, along with the job system, the
+// rewind history and the replay being recorded or played back.
+
+struct SimThread
+{
+    std::thread thread;
+    std::atomic<bool> running;
+
+    // Written by the render thread
+    std::atomic<unsigned int> heldButtons;
+    std::atomic<unsigned int> latchedButtons; // seen down since the last tick, so short taps are not lost
+    std::atomic<SimClockTime::rep> inputTime; // when the last input was read, in clock ticks since its epoch
+    std::atomic<bool> rewinding;
+
+    // Written by the simulation thread: tick a replay diverged at, or -1
+    std::atomic<long long> divergedTick;
+
+    FrameExchange frames;
+
+    // Owned by the simulation thread while it runs
+    World *world;
+    ReplayRecorder *recorder;
+    ReplayReader *reader;
+    bool replaying;
+    SnapshotRing rewind;
+    RenderTrail trail;
+};
+
+// Publishes the world's current state and starts ticking it. The world,
+// recorder and reader must outlive the thread.
+void StartSimThread(SimThread &sim, World &world, ReplayRecorder &recorder, ReplayReader &reader, bool replaying);
+void StopSimThread(SimThread &sim);
+
+// Render thread: input for the next tick, and whether to rewind instead
+void PostSimInput(SimThread &sim, const InputFrame &input, bool rewinding);
+
+#endif
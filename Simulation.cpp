@@ -0,0 +1,642 @@
+#include "Simulation.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Speeds are in pixels per second
+const float playerSpeed = 300.0f;
+const float bulletSpeed = 600.0f;
+const float enemySpeedStep = 60.0f;
+const float enemyChaseSpeed = 120.0f;
+const float dashDistance = 50.0f;
+const float bulletRadius = 10.0f;
+const float bulletInterval = 0.7f;
+const float enemyRadius = 30.0f;
+
+// Entities per job in the parallel passes, a multiple of the SIMD lane width
+const int parallelGrain = 4096;
+
+// Collision candidates handed to the swept hit kernel at a time
+const int sweptBatch = 64;
+
+// Seconds the player is invulnerable after an enemy hit
+const float collisionCooldown = 1.0f;
+
+// Waves: a new one arrives every waveInterval seconds, or waveBreak seconds
+// after the last enemy died, and its enemies spend spawnProtection seconds
+// spawning
+const float waveInterval = 20.0f;
+const float waveBreak = 2.0f;
+const float spawnProtection = 1.0f;
+
+// What a timer does when it fires
+enum TimerKind
+{
+    TIMER_EMITTER,         // data: emitter index
+    TIMER_INVULNERABILITY, // end of the player's invulnerability
+    TIMER_ENEMY_SPAWNED,   // data: enemy handle
+    TIMER_WAVE
+};
+
+const char *simPhaseNames[PHASE_COUNT] = {
+    "spawn", "bullets", "player", "enemies", "grid", "bullet_hits", "player_hits", "cleanup"};
+
+// Times consecutive phases of a tick when the world asks for it
+struct PhaseClock
+{
+    double *seconds;
+    std::chrono::steady_clock::time_point last;
+
+    explicit PhaseClock(double *phaseSeconds) : seconds(phaseSeconds)
+    {
+        if (seconds)
+        {
+            last = std::chrono::steady_clock::now();
+        }
+    }
+
+    void Lap(SimPhase phase)
+    {
+        if (seconds)
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            seconds[phase] = std::chrono::duration<double>(now - last).count();
+            last = now;
+        }
+    }
+};
+
+void UpdatePlayer(Player &player, const InputFrame &input, unsigned int pressed, float dt);
+void PlayerDash(Player &player, float distance, Vec2 dashDirection);
+void HandleExp(Player &player);
+void InitiateEnemies(World &world);
+void UpdateEnemies(World &world, float dt);
+void HandleBulletEnemyCollision(EntityArrays &bullets, int bullet, EntityArrays &enemies, int enemy);
+void RebuildEnemyGrid(World &world);
+int FindSweptEnemyHit(const World &world, const SweptCircle &circle, float dt);
+int FindBulletHit(const World &world, int bullet, float dt);
+void TriggerBulletEnemyCollision(World &world, float dt);
+void TriggerPlayerEnemyCollision(World &world, Vec2 start, float dt);
+void HandleEnemyPlayerCollision(Player &player);
+void MakePlayerInvulnerable(World &world);
+void UpdateBullets(World &world, float dt);
+void RunTimers(World &world);
+void FireWorldEmitter(World &world, int emitter);
+void SpawnWave(World &world);
+int FindNearestEnemy(const World &world);
+
+// World
+void InitWorld(World &world, int enemyCount, uint64_t seed)
+{
+    world = World{};
+    SeedRng(world.rng, seed);
+    world.kernels = &GetEntityKernels();
+    world.aimTarget = nullEntityHandle;
+    InitTimerWheel(world.timers, 0);
+
+    // Initiate player
+    world.player = {
+        {screenWidth / 2, screenHeight / 2},
+        {0, 0},
+        20,
+        colorBlack,
+        100,
+        1,
+        0,
+        false};
+
+    // Initiate enemies
+    world.startingEnemies = enemyCount;
+    ReserveEntityArrays(world.enemies, enemyCount);
+    InitiateEnemies(world);
+    ReserveEntityArrays(world.bullets, initialBulletCapacity);
+
+    // Eight bullets around the player, as the original weapon
+    AddEmitter(world, MakeEmitter(EMITTER_RING, 8, bulletSpeed, bulletRadius, bulletInterval, colorDarkGray));
+    InitSpatialGrid(world.enemyGrid, screenWidth, screenHeight, enemyRadius);
+    InitFlowField(world.enemyFlow, screenWidth, screenHeight, 2.0f * enemyRadius);
+
+    world.currentLevel = 1;
+    world.waveTimer = ScheduleTimer(world.timers, SecondsToTicks(waveInterval), TIMER_WAVE, 0);
+
+    // Enemies can spawn on the player, so it starts with the same grace as
+    // after a hit
+    MakePlayerInvulnerable(world);
+}
+void StepWorld(World &world, float dt, const InputFrame &input)
+{
+    PROFILE_SCOPE("StepWorld");
+    unsigned int pressed = input.buttons & ~world.previousButtons;
+    world.previousButtons = input.buttons;
+    world.tick++;
+    world.time += dt;
+
+    PhaseClock clock(world.phaseSeconds);
+
+    // Timers, which fire the emitters
+    RunTimers(world);
+    clock.Lap(PHASE_SPAWN);
+    UpdateBullets(world, dt);
+    clock.Lap(PHASE_BULLETS);
+
+    // Player
+    HandleExp(world.player);
+    Vec2 playerStart = world.player.position;
+    UpdatePlayer(world.player, input, pressed, dt);
+    clock.Lap(PHASE_PLAYER);
+
+    // Enemies
+    UpdateEnemies(world, dt);
+    clock.Lap(PHASE_ENEMIES);
+
+    // Collisions
+    RebuildEnemyGrid(world);
+    clock.Lap(PHASE_GRID);
+    TriggerBulletEnemyCollision(world, dt);
+    clock.Lap(PHASE_BULLET_HITS);
+    TriggerPlayerEnemyCollision(world, playerStart, dt);
+    clock.Lap(PHASE_PLAYER_HITS);
+
+    // Release spent and culled bullets and killed enemies
+    RemoveInactiveEntities(world.bullets);
+    RemoveInactiveHandledEntities(world.enemies, world.enemyHandles);
+    clock.Lap(PHASE_CLEANUP);
+
+    // Bring the next wave forward once the field is clear
+    long long nextWave = world.tick + SecondsToTicks(waveBreak);
+    if (world.enemies.count == 0 && TimerDue(world.timers, world.waveTimer) > nextWave)
+    {
+        CancelTimer(world.timers, world.waveTimer);
+        world.waveTimer = ScheduleTimer(world.timers, nextWave, TIMER_WAVE, 0);
+    }
+
+    if (world.player.hp <= 0 && (pressed & INPUT_RESTART))
+    {
+        ResetGame(world);
+    }
+}
+
+// Player
+
+void UpdatePlayer(Player &player, const InputFrame &input, unsigned int pressed, float dt)
+{
+    PROFILE_SCOPE("UpdatePlayer");
+    Vec2 movementInput = {0, 0};
+
+    if (input.buttons & INPUT_RIGHT)
+    {
+        movementInput.x += 1;
+    }
+
+    if (input.buttons & INPUT_LEFT)
+    {
+        movementInput.x -= 1;
+    }
+
+    if (input.buttons & INPUT_DOWN)
+    {
+        movementInput.y += 1;
+    }
+
+    if (input.buttons & INPUT_UP)
+    {
+        movementInput.y -= 1;
+    }
+
+    // Dash when the dash button is pressed
+    if (pressed & INPUT_DASH)
+    {
+        // Use the movement input as the dash direction
+        PlayerDash(player, dashDistance, movementInput);
+    }
+
+    // Normalize the movement input to ensure consistent speed
+    movementInput = Vec2Normalize(movementInput);
+
+    // Update player speed based on the movement input
+    player.speed = Vec2Scale(movementInput, playerSpeed);
+
+    // Update player position based on the speed vector
+    player.position.x += player.speed.x * dt;
+    player.position.y += player.speed.y * dt;
+
+    // Ensure player stays within the screen bounds
+    player.position.x = ClampFloat(player.position.x, player.radius, screenWidth - player.radius);
+    player.position.y = ClampFloat(player.position.y, player.radius, screenHeight - player.radius);
+}
+void PlayerDash(Player &player, float dashDistance, Vec2 dashDirection)
+{
+    // Store the current speed for later restoration
+    Vec2 originalSpeed = player.speed;
+
+    // Normalize the dash direction to ensure consistent dash distance
+    dashDirection = Vec2Normalize(dashDirection);
+
+    // Calculate the dash vector based on the normalized dash direction
+    Vec2 dashVector = Vec2Scale(dashDirection, dashDistance);
+
+    // Apply the dash vector to the player's position
+    player.position = Vec2Add(player.position, dashVector);
+
+    // Restore the original speed
+    player.speed = originalSpeed;
+}
+void HandleExp(Player &player)
+{
+    if (player.exp == 100)
+    {
+        player.lvl++;
+        player.exp = 0;
+    }
+}
+
+// Enemies
+void InitiateEnemies(World &world)
+{
+    ClearHandledEntities(world.enemies, world.enemyHandles);
+    SpawnEnemies(world, world.startingEnemies);
+}
+int SpawnEnemies(World &world, int count)
+{
+    EntityArrays &enemies = world.enemies;
+    Rng &rng = world.rng;
+    int first = AddHandledEntities(enemies, world.enemyHandles, count);
+    for (int i = first; i < enemies.count; ++i)
+    {
+        enemies.x[i] = (float)RandomValue(rng, 0, screenWidth);
+        enemies.y[i] = (float)RandomValue(rng, 0, screenHeight);
+        enemies.radius[i] = enemyRadius;
+        enemies.color[i] = {(unsigned char)RandomValue(rng, 0, 255), (unsigned char)RandomValue(rng, 0, 255), (unsigned char)RandomValue(rng, 0, 255), 255};
+        enemies.vx[i] = RandomValue(rng, -4, 4) * enemySpeedStep;
+        enemies.vy[i] = RandomValue(rng, -4, 4) * enemySpeedStep;
+        enemies.active[i] = ENEMY_ALIVE;
+    }
+    return first;
+}
+void UpdateEnemies(World &world, float dt)
+{
+    PROFILE_SCOPE("UpdateEnemies");
+    // Enemies chase the player through the flow field, keeping apart through
+    // its density grid, then move and bounce on walls
+    EntityArrays &enemies = world.enemies;
+    FlowField &flow = world.enemyFlow;
+    UpdateFlowField(flow, world.player.position);
+    AccumulateDensity(flow, enemies);
+
+    MoveBounceKernel moveBounce = world.kernels->moveBounce;
+    world.enemyStartX.resize(enemies.count);
+    world.enemyStartY.resize(enemies.count);
+    ParallelFor(world.jobs, enemies.count, parallelGrain, [&](int begin, int end) {
+        std::copy(enemies.x.begin() + begin, enemies.x.begin() + end, world.enemyStartX.begin() + begin);
+        std::copy(enemies.y.begin() + begin, enemies.y.begin() + end, world.enemyStartY.begin() + begin);
+        SteerEntities(flow, enemies, begin, end, enemyChaseSpeed, dt);
+        moveBounce(&enemies.x[begin], &enemies.y[begin], &enemies.vx[begin], &enemies.vy[begin], &enemies.radius[begin],
+                   end - begin, dt, screenWidth, screenHeight);
+    });
+}
+
+// Collisions
+void HandleBulletEnemyCollision(EntityArrays &bullets, int bullet, EntityArrays &enemies, int enemy)
+{
+    // Both are released at the end of the tick
+    bullets.active[bullet] = 0;
+    enemies.active[enemy] = ENEMY_DEAD;
+}
+void RebuildEnemyGrid(World &world)
+{
+    PROFILE_SCOPE("RebuildEnemyGrid");
+    SpatialGrid &grid = world.enemyGrid;
+    const EntityArrays &enemies = world.enemies;
+    grid.itemCells.resize(enemies.count);
+    ParallelFor(world.jobs, enemies.count, parallelGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            grid.itemCells[i] = SpatialGridCell(grid, enemies.x[i], enemies.y[i]);
+        }
+    });
+    BuildSpatialGrid(grid, enemies.count);
+}
+// Live enemy the circle touches first while both move through the tick, or
+// -1. Ties go to the lowest index, so the result does not depend on the
+// grid's visiting order. Enemies are swept from where they began the tick,
+// so one that bounced off a wall is still on the right side of it.
+int FindSweptEnemyHit(const World &world, const SweptCircle &circle, float dt)
+{
+    const EntityArrays &enemies = world.enemies;
+    SweptHitKernel sweptHit = world.kernels->sweptHit;
+
+    // The grid holds where enemies end the tick, and steering caps their
+    // speed at enemyChaseSpeed, so look around the middle of the circle's
+    // path far enough to cover both motions
+    float length = std::sqrt(circle.dx * circle.dx + circle.dy * circle.dy);
+    float reach = circle.radius + 0.5f * length + enemyChaseSpeed * dt;
+
+    int candidates[sweptBatch];
+    int count = 0;
+    SweptHit hit = {-1, 1.0f};
+    QuerySpatialGrid(world.enemyGrid, circle.x - 0.5f * circle.dx, circle.y - 0.5f * circle.dy, reach, [&](int j) {
+        // Once something is hit at the very start only lower indices can win
+        if (enemies.active[j] == ENEMY_ALIVE && !(hit.time == 0.0f && j > hit.entity))
+        {
+            candidates[count++] = j;
+            if (count == sweptBatch)
+            {
+                sweptHit(enemies.x.data(), enemies.y.data(), world.enemyStartX.data(), world.enemyStartY.data(),
+                         enemies.radius.data(), candidates, count, circle, hit);
+                count = 0;
+            }
+        }
+    });
+    sweptHit(enemies.x.data(), enemies.y.data(), world.enemyStartX.data(), world.enemyStartY.data(),
+             enemies.radius.data(), candidates, count, circle, hit);
+    return hit.entity;
+}
+// A bullet is spent on the first enemy in its path
+int FindBulletHit(const World &world, int bullet, float dt)
+{
+    const EntityArrays &bullets = world.bullets;
+    SweptCircle circle = {bullets.x[bullet], bullets.y[bullet], bullets.vx[bullet] * dt, bullets.vy[bullet] * dt,
+                          bullets.radius[bullet]};
+    return FindSweptEnemyHit(world, circle, dt);
+}
+void TriggerBulletEnemyCollision(World &world, float dt)
+{
+    PROFILE_SCOPE("TriggerBulletEnemyCollision");
+    EntityArrays &bullets = world.bullets;
+    world.bulletHits.resize(bullets.count);
+
+    // Find hits in parallel against the enemies as they are before this pass.
+    // Every bullet was live when the tick began, including those UpdateBullets
+    // culled for leaving the screen, so all of them are swept; a bullet can
+    // pass an enemy by the wall on its way out.
+    ParallelFor(world.jobs, bullets.count, parallelGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            world.bulletHits[i] = FindBulletHit(world, i, dt);
+        }
+    });
+
+    // Apply them in bullet order. An enemy already killed earlier in the pass
+    // is spent, so that bullet looks again, as a serial pass would.
+    for (int i = 0; i < bullets.count; ++i)
+    {
+        int hit = world.bulletHits[i];
+        if (hit >= 0 && world.enemies.active[hit] != ENEMY_ALIVE)
+        {
+            hit = FindBulletHit(world, i, dt);
+        }
+
+        if (hit >= 0)
+        {
+            HandleBulletEnemyCollision(bullets, i, world.enemies, hit);
+            world.player.exp += 10;
+        }
+    }
+}
+// The player is swept from where it started the tick to where it ended,
+// dash and wall clamping included
+void TriggerPlayerEnemyCollision(World &world, Vec2 start, float dt)
+{
+    PROFILE_SCOPE("TriggerPlayerEnemyCollision");
+    if (!world.player.invulnerable)
+    {
+        const Player &player = world.player;
+        SweptCircle circle = {player.position.x, player.position.y, player.position.x - start.x,
+                              player.position.y - start.y, player.radius};
+
+        if (FindSweptEnemyHit(world, circle, dt) >= 0)
+        {
+            HandleEnemyPlayerCollision(world.player);
+            MakePlayerInvulnerable(world);
+        }
+    }
+}
+// Invulnerable until the timer runs out
+void MakePlayerInvulnerable(World &world)
+{
+    world.player.invulnerable = true;
+    ScheduleTimer(world.timers, world.tick + SecondsToTicks(collisionCooldown), TIMER_INVULNERABILITY, 0);
+}
+
+void HandleEnemyPlayerCollision(Player &player)
+{
+    player.hp -= 50;
+    if (player.hp <= 0)
+    {
+        player.hp = 0;
+    }
+}
+// Bullets
+void UpdateBullets(World &world, float dt)
+{
+    PROFILE_SCOPE("UpdateBullets");
+    // Bullet movement, deactivating bullets that leave the screen. They still
+    // take part in this tick's hit pass and are released at its end.
+    EntityArrays &bullets = world.bullets;
+    MoveCullKernel moveCull = world.kernels->moveCull;
+    ParallelFor(world.jobs, bullets.count, parallelGrain, [&](int begin, int end) {
+        moveCull(&bullets.x[begin], &bullets.y[begin], &bullets.vx[begin], &bullets.vy[begin], &bullets.active[begin],
+                 end - begin, dt, screenWidth, screenHeight);
+    });
+}
+// Timers
+uint64_t PackEntityHandle(EntityHandle handle)
+{
+    return (uint64_t)handle.slot << 32 | handle.generation;
+}
+EntityHandle UnpackEntityHandle(uint64_t data)
+{
+    return {(uint32_t)(data >> 32), (uint32_t)data};
+}
+void RunTimers(World &world)
+{
+    PROFILE_SCOPE("RunTimers");
+    world.firedTimers.clear();
+    AdvanceTimerWheel(world.timers, world.tick, world.firedTimers);
+
+    for (const TimerEvent &event : world.firedTimers)
+    {
+        switch (event.kind)
+        {
+        case TIMER_EMITTER:
+            FireWorldEmitter(world, (int)event.data);
+            break;
+        case TIMER_INVULNERABILITY:
+            world.player.invulnerable = false;
+            break;
+        case TIMER_ENEMY_SPAWNED:
+        {
+            // The enemy may have been cleared by a restart since
+            int enemy = ResolveEntityHandle(world.enemyHandles, UnpackEntityHandle(event.data));
+            if (enemy >= 0)
+            {
+                world.enemies.active[enemy] = ENEMY_ALIVE;
+            }
+            break;
+        }
+        case TIMER_WAVE:
+            SpawnWave(world);
+            break;
+        }
+    }
+}
+
+// Emitters
+void AddEmitter(World &world, const Emitter &emitter)
+{
+    world.emitters.push_back(emitter);
+    world.emitterTimers.push_back(ScheduleTimer(world.timers, world.tick + SecondsToTicks(emitter.interval), TIMER_EMITTER,
+                                                world.emitters.size() - 1));
+}
+void ClearEmitters(World &world)
+{
+    for (TimerHandle timer : world.emitterTimers)
+    {
+        CancelTimer(world.timers, timer);
+    }
+    world.emitters.clear();
+    world.emitterTimers.clear();
+}
+void FireWorldEmitter(World &world, int index)
+{
+    PROFILE_SCOPE("SpawnBullets");
+    Emitter &emitter = world.emitters[index];
+
+    // Aimed emitters keep their target until it is gone
+    Vec2 target = world.player.position;
+    if (emitter.pattern == EMITTER_AIMED)
+    {
+        int enemy = ResolveEntityHandle(world.enemyHandles, world.aimTarget);
+        if (enemy < 0)
+        {
+            enemy = FindNearestEnemy(world);
+            world.aimTarget = enemy >= 0 ? GetEntityHandle(world.enemyHandles, enemy) : nullEntityHandle;
+        }
+        if (enemy >= 0)
+        {
+            target = {world.enemies.x[enemy], world.enemies.y[enemy]};
+        }
+    }
+
+    FireEmitter(emitter, world.bullets, world.player.position, target);
+    world.emitterTimers[index] = ScheduleTimer(world.timers, world.tick + SecondsToTicks(emitter.interval), TIMER_EMITTER, index);
+}
+// Index of the live enemy closest to the player, or -1 when there is none
+int FindNearestEnemy(const World &world)
+{
+    const EntityArrays &enemies = world.enemies;
+    int nearest = -1;
+    float nearestDistance = -1.0f;
+    for (int i = 0; i < enemies.count; ++i)
+    {
+        float dx = enemies.x[i] - world.player.position.x;
+        float dy = enemies.y[i] - world.player.position.y;
+        float distance = dx * dx + dy * dy;
+        if (nearestDistance < 0 || distance < nearestDistance)
+        {
+            nearest = i;
+            nearestDistance = distance;
+        }
+    }
+    return nearest;
+}
+
+void ResetGame(World &world)
+{
+    world.player.hp = 100;
+    world.player.exp = 0;
+    world.player.lvl = 1;
+    world.player.position = {screenWidth / 2, screenHeight / 2};
+
+    InitiateEnemies(world);
+    world.aimTarget = nullEntityHandle;
+
+    world.bullets.count = 0;
+
+    // Start every clock over, with the grace a new game starts with
+    ClearTimerWheel(world.timers);
+    MakePlayerInvulnerable(world);
+    for (size_t i = 0; i < world.emitters.size(); ++i)
+    {
+        world.emitterTimers[i] = ScheduleTimer(world.timers, world.tick + SecondsToTicks(world.emitters[i].interval),
+                                               TIMER_EMITTER, i);
+    }
+
+    world.currentLevel = 1;
+    world.waveTimer = ScheduleTimer(world.timers, world.tick + SecondsToTicks(waveInterval), TIMER_WAVE, 0);
+}
+
+// Waves
+void SpawnWave(World &world)
+{
+    world.currentLevel++;
+
+    // Enemies fade in harmlessly before they join in
+    long long spawned = world.tick + SecondsToTicks(spawnProtection);
+    int first = SpawnEnemies(world, world.startingEnemies);
+    for (int i = first; i < world.enemies.count; ++i)
+    {
+        world.enemies.active[i] = ENEMY_SPAWNING;
+        ScheduleTimer(world.timers, spawned, TIMER_ENEMY_SPAWNED, PackEntityHandle(GetEntityHandle(world.enemyHandles, i)));
+    }
+
+    world.waveTimer = ScheduleTimer(world.timers, world.tick + SecondsToTicks(waveInterval), TIMER_WAVE, 0);
+}
+
+// Checksum (FNV-1a)
+void HashBytes(uint64_t &hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+}
+void HashEntities(uint64_t &hash, const EntityArrays &entities)
+{
+    size_t count = (size_t)entities.count;
+    HashBytes(hash, &entities.count, sizeof(entities.count));
+    HashBytes(hash, entities.x.data(), count * sizeof(float));
+    HashBytes(hash, entities.y.data(), count * sizeof(float));
+    HashBytes(hash, entities.vx.data(), count * sizeof(float));
+    HashBytes(hash, entities.vy.data(), count * sizeof(float));
+    HashBytes(hash, entities.radius.data(), count * sizeof(float));
+    HashBytes(hash, entities.active.data(), count);
+}
+// Pending timers, slot by slot in firing order
+void HashTimers(uint64_t &hash, const TimerWheel &wheel)
+{
+    for (int slot = 0; slot < timerWheelLevels * timerWheelSlots; ++slot)
+    {
+        for (int index = wheel.lists.heads[slot]; index >= 0; index = wheel.timers[index].next)
+        {
+            const Timer &timer = wheel.timers[index];
+            HashBytes(hash, &timer.due, sizeof(timer.due));
+            HashBytes(hash, &timer.kind, sizeof(timer.kind));
+            HashBytes(hash, &timer.data, sizeof(timer.data));
+        }
+    }
+}
+uint64_t ChecksumWorld(const World &world)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    const Player &player = world.player;
+    HashBytes(hash, &player.position, sizeof(player.position));
+    HashBytes(hash, &player.hp, sizeof(player.hp));
+    HashBytes(hash, &player.lvl, sizeof(player.lvl));
+    HashBytes(hash, &player.exp, sizeof(player.exp));
+    HashBytes(hash, &player.invulnerable, sizeof(player.invulnerable));
+    HashEntities(hash, world.enemies);
+    HashEntities(hash, world.bullets);
+    for (const Emitter &emitter : world.emitters)
+    {
+        HashBytes(hash, &emitter.angle, sizeof(emitter.angle));
+    }
+    HashBytes(hash, &world.aimTarget, sizeof(world.aimTarget));
+    HashBytes(hash, &world.tick, sizeof(world.tick));
+    HashTimers(hash, world.timers);
+    HashBytes(hash, &world.rng.state, sizeof(world.rng.state));
+    HashBytes(hash, &world.currentLevel, sizeof(world.currentLevel));
+    return hash;
+}
@@ -0,0 +1,162 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Emitters.h"
+#include "EntityArrays.h"
+#include "EntityHandles.h"
+#include "FlowField.h"
+#include "JobSystem.h"
+#include "Kernels.h"
+#include "Random.h"
+#include "SimMath.h"
+#include "SpatialGrid.h"
+#include "TimerWheel.h"
+#include <cstdint>
+#include <vector>
+
+// The simulation owns all gameplay state and advances it in fixed ticks.
+// It never draws and never calls raylib, so it also runs headless.
+
+// Window dimensions
+const int screenWidth{1800};
+const int screenHeight{900};
+
+// Fixed simulation tick
+const float simTickRate = 60.0f;
+const float simDt = 1.0f / simTickRate;
+
+// Entity counts
+const int maxEnemies = 30; // default enemy count
+const int initialBulletCapacity = 1024;
+
+// Input buttons held during a tick
+enum InputButton
+{
+    INPUT_RIGHT = 1 << 0,
+    INPUT_LEFT = 1 << 1,
+    INPUT_DOWN = 1 << 2,
+    INPUT_UP = 1 << 3,
+    INPUT_DASH = 1 << 4,
+    INPUT_RESTART = 1 << 5
+};
+
+struct InputFrame
+{
+    unsigned int buttons;
+};
+
+// Parts of a tick, in the order StepWorld runs them
+enum SimPhase
+{
+    PHASE_SPAWN,
+    PHASE_BULLETS,
+    PHASE_PLAYER,
+    PHASE_ENEMIES,
+    PHASE_GRID,
+    PHASE_BULLET_HITS,
+    PHASE_PLAYER_HITS,
+    PHASE_CLEANUP,
+    PHASE_COUNT
+};
+
+extern const char *simPhaseNames[PHASE_COUNT];
+
+// Values of the enemies' active column
+enum EnemyState
+{
+    ENEMY_DEAD = 0,    // killed this tick, released at the end of it
+    ENEMY_ALIVE = 1,
+    ENEMY_SPAWNING = 2 // just arrived with a wave, cannot hit or be hit yet
+};
+
+// Converts a duration to whole ticks, at least one
+inline long long SecondsToTicks(float seconds)
+{
+    long long ticks = (long long)(seconds * simTickRate + 0.5f);
+    return ticks > 0 ? ticks : 1;
+}
+
+struct Player
+{
+    Vec2 position;
+    Vec2 speed;
+    float radius;
+    Rgba color;
+    int hp;
+    int lvl;
+    int exp;
+    bool invulnerable; // for a while after an enemy hit
+};
+
+struct World
+{
+    Player player;
+    EntityArrays enemies; // live enemies only, kept dense
+    EntityArrays bullets; // live bullets only, kept dense
+    EntityHandles enemyHandles;
+
+    // Integration kernels picked for this CPU
+    const EntityKernels *kernels;
+
+    // Optional worker threads for the per-tick passes, not owned; null runs
+    // everything on the calling thread with the same results
+    JobSystem *jobs;
+
+    // Enemy hit by each bullet in the current collision pass, or -1
+    std::vector<int> bulletHits;
+
+    // Where each enemy began the tick, so the swept tests follow the path it
+    // moved along, bounces included
+    FloatArray enemyStartX;
+    FloatArray enemyStartY;
+
+    // Optional, not owned: receives the seconds spent in each phase of the
+    // last tick. Null skips the clock reads.
+    double *phaseSeconds;
+
+    // Broadphase over enemies, rebuilt every tick
+    SpatialGrid enemyGrid;
+
+    // Steers enemies toward the player, rebuilt when the player changes cell
+    FlowField enemyFlow;
+
+    // Bullet patterns fired from the player, each on its own timer
+    std::vector<Emitter> emitters;
+    std::vector<TimerHandle> emitterTimers;
+
+    // Enemy the aimed emitters keep firing at until it dies
+    EntityHandle aimTarget;
+
+    // Everything that happens after a delay: volleys, the end of the player's
+    // invulnerability, enemies finishing spawning and the next wave
+    TimerWheel timers;
+    std::vector<TimerEvent> firedTimers;
+    TimerHandle waveTimer;
+
+    // Simulation clock, the only time source gameplay reads
+    long long tick;
+    float time;
+
+    // State
+    Rng rng;
+    int startingEnemies; // enemies spawned by each (re)start
+    int currentLevel; // wave number, starting at 1
+    unsigned int previousButtons;
+};
+
+// Simulation functions
+void InitWorld(World &world, int enemyCount = maxEnemies, uint64_t seed = 1);
+void StepWorld(World &world, float dt, const InputFrame &input);
+void ResetGame(World &world);
+
+// Adds count enemies at random places, returns the index of the first
+int SpawnEnemies(World &world, int count);
+
+// Emitters fire on their own timers from the tick after they are added
+void AddEmitter(World &world, const Emitter &emitter);
+void ClearEmitters(World &world);
+
+// Hash of all gameplay state, equal for equal runs on any thread count
+uint64_t ChecksumWorld(const World &world);
+
+#endif
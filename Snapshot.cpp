@@ -0,0 +1,416 @@
+#include "Snapshot.h"
+#include <cstring>
+
+// Section 0 of every snapshot: the world's scalar state and the lengths of
+// the arrays that follow
+struct SnapshotScalars
+{
+    Player player;
+    EntityHandle aimTarget;
+    TimerHandle waveTimer;
+    long long timerNow;
+    long long tick;
+    float time;
+    Rng rng;
+    int currentLevel;
+    int startingEnemies;
+    unsigned int previousButtons;
+
+    int enemyCount;
+    int bulletCount;
+    int handleSlots;
+    int freeSlots;
+    int emitterCount;
+    int timerCount;
+    int freeTimers;
+};
+
+SnapshotScalars GetSnapshotScalars(const World &world)
+{
+    SnapshotScalars scalars;
+    std::memset(&scalars, 0, sizeof(scalars)); // no stray padding bytes in deltas
+    scalars.player = world.player;
+    scalars.aimTarget = world.aimTarget;
+    scalars.waveTimer = world.waveTimer;
+    scalars.timerNow = world.timers.now;
+    scalars.tick = world.tick;
+    scalars.time = world.time;
+    scalars.rng = world.rng;
+    scalars.currentLevel = world.currentLevel;
+    scalars.startingEnemies = world.startingEnemies;
+    scalars.previousButtons = world.previousButtons;
+    scalars.enemyCount = world.enemies.count;
+    scalars.bulletCount = world.bullets.count;
+    scalars.handleSlots = (int)world.enemyHandles.denseOf.size();
+    scalars.freeSlots = (int)world.enemyHandles.freeSlots.size();
+    scalars.emitterCount = (int)world.emitters.size();
+    scalars.timerCount = (int)world.timers.timers.size();
+    scalars.freeTimers = (int)world.timers.freeTimers.size();
+    return scalars;
+}
+
+// Sizes the world's arrays to the snapshot's and copies the scalars back
+void ApplySnapshotScalars(World &world, const SnapshotScalars &scalars)
+{
+    world.player = scalars.player;
+    world.aimTarget = scalars.aimTarget;
+    world.waveTimer = scalars.waveTimer;
+    world.timers.now = scalars.timerNow;
+    world.tick = scalars.tick;
+    world.time = scalars.time;
+    world.rng = scalars.rng;
+    world.currentLevel = scalars.currentLevel;
+    world.startingEnemies = scalars.startingEnemies;
+    world.previousButtons = scalars.previousButtons;
+
+    ResizeEntityArrays(world.enemies, scalars.enemyCount);
+    ResizeEntityArrays(world.bullets, scalars.bulletCount);
+    world.enemyHandles.slotOf.resize(scalars.enemyCount);
+    world.enemyHandles.denseOf.resize(scalars.handleSlots);
+    world.enemyHandles.generation.resize(scalars.handleSlots);
+    world.enemyHandles.freeSlots.resize(scalars.freeSlots);
+    world.emitters.resize(scalars.emitterCount);
+    world.emitterTimers.resize(scalars.emitterCount);
+    world.timers.timers.resize(scalars.timerCount);
+    world.timers.freeTimers.resize(scalars.freeTimers);
+}
+
+void AddSection(const void *data, size_t size, int &section, const void *sections[], uint32_t sizes[])
+{
+    sections[section] = data;
+    sizes[section] = (uint32_t)size;
+    section++;
+}
+
+void AddEntitySections(const EntityArrays &entities, int &section, const void *sections[], uint32_t sizes[])
+{
+    size_t count = (size_t)entities.count;
+    AddSection(entities.x.data(), count * sizeof(float), section, sections, sizes);
+    AddSection(entities.y.data(), count * sizeof(float), section, sections, sizes);
+    AddSection(entities.vx.data(), count * sizeof(float), section, sections, sizes);
+    AddSection(entities.vy.data(), count * sizeof(float), section, sections, sizes);
+    AddSection(entities.radius.data(), count * sizeof(float), section, sections, sizes);
+    AddSection(entities.color.data(), count * sizeof(Rgba), section, sections, sizes);
+    AddSection(entities.active.data(), count, section, sections, sizes);
+}
+
+// Where each section of the world lives and how long it is. Restoring writes
+// through these pointers, which is fine as that world is not const.
+void GetWorldSections(const World &world, const SnapshotScalars &scalars, const void *sections[], uint32_t sizes[])
+{
+    const EntityHandles &handles = world.enemyHandles;
+    int section = 0;
+    AddSection(&scalars, sizeof(scalars), section, sections, sizes);
+    AddEntitySections(world.enemies, section, sections, sizes);
+    AddEntitySections(world.bullets, section, sections, sizes);
+    AddSection(handles.slotOf.data(), handles.slotOf.size() * sizeof(uint32_t), section, sections, sizes);
+    AddSection(handles.denseOf.data(), handles.denseOf.size() * sizeof(int), section, sections, sizes);
+    AddSection(handles.generation.data(), handles.generation.size() * sizeof(uint32_t), section, sections, sizes);
+    AddSection(handles.freeSlots.data(), handles.freeSlots.size() * sizeof(uint32_t), section, sections, sizes);
+    AddSection(world.emitters.data(), world.emitters.size() * sizeof(Emitter), section, sections, sizes);
+    AddSection(world.emitterTimers.data(), world.emitterTimers.size() * sizeof(TimerHandle), section, sections, sizes);
+    AddSection(&world.timers.lists, sizeof(TimerLists), section, sections, sizes);
+    AddSection(world.timers.timers.data(), world.timers.timers.size() * sizeof(Timer), section, sections, sizes);
+    AddSection(world.timers.freeTimers.data(), world.timers.freeTimers.size() * sizeof(int), section, sections, sizes);
+}
+
+void CopyBytes(void *destination, const void *source, size_t size)
+{
+    if (size > 0)
+    {
+        std::memcpy(destination, source, size);
+    }
+}
+
+// Full snapshots
+void SaveWorldSnapshot(const World &world, WorldSnapshot &snapshot)
+{
+    SnapshotScalars scalars = GetSnapshotScalars(world);
+    const void *sections[snapshotSectionCount];
+    GetWorldSections(world, scalars, sections, snapshot.sectionSizes);
+
+    size_t total = 0;
+    for (int i = 0; i < snapshotSectionCount; ++i)
+    {
+        total += snapshot.sectionSizes[i];
+    }
+    snapshot.tick = world.tick;
+    snapshot.delta = false;
+    snapshot.keyframeTick = world.tick;
+    snapshot.bytes.resize(total);
+    snapshot.blocks.clear();
+
+    unsigned char *out = snapshot.bytes.data();
+    for (int i = 0; i < snapshotSectionCount; ++i)
+    {
+        CopyBytes(out, sections[i], snapshot.sectionSizes[i]);
+        out += snapshot.sectionSizes[i];
+    }
+}
+
+void RestoreWorldSnapshot(World &world, const WorldSnapshot &snapshot)
+{
+    SnapshotScalars scalars;
+    std::memcpy(&scalars, snapshot.bytes.data(), sizeof(scalars));
+    ApplySnapshotScalars(world, scalars);
+
+    const void *sections[snapshotSectionCount];
+    uint32_t sizes[snapshotSectionCount];
+    GetWorldSections(world, scalars, sections, sizes);
+
+    const unsigned char *in = snapshot.bytes.data();
+    for (int i = 0; i < snapshotSectionCount; ++i)
+    {
+        if (i > 0)
+        {
+            CopyBytes(const_cast<void *>(sections[i]), in, sizes[i]);
+        }
+        in += snapshot.sectionSizes[i];
+    }
+}
+
+// Delta snapshots
+bool SaveWorldDelta(const World &world, const WorldSnapshot &keyframe, WorldSnapshot &snapshot, size_t budget)
+{
+    SnapshotScalars scalars = GetSnapshotScalars(world);
+    const void *sections[snapshotSectionCount];
+    GetWorldSections(world, scalars, sections, snapshot.sectionSizes);
+
+    snapshot.tick = world.tick;
+    snapshot.delta = true;
+    snapshot.keyframeTick = keyframe.tick;
+    snapshot.bytes.clear();
+    snapshot.blocks.clear();
+
+    const unsigned char *base = keyframe.bytes.data();
+    for (int i = 0; i < snapshotSectionCount; ++i)
+    {
+        const unsigned char *current = static_cast<const unsigned char *>(sections[i]);
+        uint32_t size = snapshot.sectionSizes[i];
+        uint32_t baseSize = keyframe.sectionSizes[i];
+
+        // Blocks past the end of the keyframe's section always count as changed
+        for (uint32_t offset = 0, block = 0; offset < size; offset += snapshotBlockSize, ++block)
+        {
+            uint32_t length = size - offset < (uint32_t)snapshotBlockSize ? size - offset : snapshotBlockSize;
+            if (offset + length <= baseSize && std::memcmp(current + offset, base + offset, length) == 0)
+            {
+                continue;
+            }
+            if (snapshot.bytes.size() + length > budget)
+            {
+                return false;
+            }
+            snapshot.blocks.push_back((uint32_t)i << 24 | block);
+            snapshot.bytes.insert(snapshot.bytes.end(), current + offset, current + offset + length);
+        }
+        base += baseSize;
+    }
+    return true;
+}
+
+void RestoreWorldDelta(World &world, const WorldSnapshot &keyframe, const WorldSnapshot &snapshot)
+{
+    if (!snapshot.delta)
+    {
+        RestoreWorldSnapshot(world, snapshot);
+        return;
+    }
+
+    // Offsets of the keyframe's sections, and the scalars, which are smaller
+    // than one block so either changed whole or not at all
+    const unsigned char *baseSections[snapshotSectionCount];
+    const unsigned char *base = keyframe.bytes.data();
+    for (int i = 0; i < snapshotSectionCount; ++i)
+    {
+        baseSections[i] = base;
+        base += keyframe.sectionSizes[i];
+    }
+
+    SnapshotScalars scalars;
+    bool scalarsChanged = !snapshot.blocks.empty() && snapshot.blocks[0] == 0;
+    std::memcpy(&scalars, scalarsChanged ? snapshot.bytes.data() : baseSections[0], sizeof(scalars));
+    ApplySnapshotScalars(world, scalars);
+
+    const void *sections[snapshotSectionCount];
+    uint32_t sizes[snapshotSectionCount];
+    GetWorldSections(world, scalars, sections, sizes);
+
+    // Keyframe bytes first, then the changed blocks on top
+    for (int i = 1; i < snapshotSectionCount; ++i)
+    {
+        size_t shared = sizes[i] < keyframe.sectionSizes[i] ? sizes[i] : keyframe.sectionSizes[i];
+        CopyBytes(const_cast<void *>(sections[i]), baseSections[i], shared);
+    }
+
+    const unsigned char *in = snapshot.bytes.data();
+    for (uint32_t entry : snapshot.blocks)
+    {
+        uint32_t section = entry >> 24;
+        uint32_t offset = (entry & 0xFFFFFF) * snapshotBlockSize;
+        uint32_t length = sizes[section] - offset < (uint32_t)snapshotBlockSize ? sizes[section] - offset : snapshotBlockSize;
+        if (section > 0)
+        {
+            CopyBytes(static_cast<unsigned char *>(const_cast<void *>(sections[section])) + offset, in, length);
+        }
+        in += length;
+    }
+}
+
+// Ring
+void InitSnapshotRing(SnapshotRing &ring, const World &world, int capacity, int keyframeInterval)
+{
+    ring.snapshots.resize(capacity > 0 ? capacity : 1);
+    ring.keyframeInterval = keyframeInterval > 0 ? keyframeInterval : 1;
+    ring.next = 0;
+    ring.count = 0;
+    ring.keyframe = -1;
+    ring.nextKeyframe = 0;
+
+    // Enough keyframes to cover the ring at the regular interval, plus the one
+    // the oldest deltas still apply to and the one being replaced
+    int capacityKeyframes = ((int)ring.snapshots.size() + ring.keyframeInterval - 1) / ring.keyframeInterval;
+    ring.keyframes.resize(capacityKeyframes + 2);
+    ring.deltaBudget = snapshotDeltaBudget;
+
+    // A delta of world is never larger than a full image of it
+    WorldSnapshot probe;
+    SaveWorldSnapshot(world, probe);
+    size_t deltaBytes = probe.bytes.size() < ring.deltaBudget ? probe.bytes.size() : ring.deltaBudget;
+    for (WorldSnapshot &keyframe : ring.keyframes)
+    {
+        keyframe.tick = -1;
+        keyframe.bytes.reserve(probe.bytes.size());
+    }
+    // Every block of a delta but the last of each section is whole
+    for (WorldSnapshot &snapshot : ring.snapshots)
+    {
+        snapshot.bytes.reserve(deltaBytes);
+        snapshot.blocks.reserve(deltaBytes / snapshotBlockSize + snapshotSectionCount);
+    }
+}
+
+// Keyframe slot holding the full snapshot of tick, or -1
+int FindKeyframe(const SnapshotRing &ring, long long tick)
+{
+    for (int i = 0; i < (int)ring.keyframes.size(); ++i)
+    {
+        if (ring.keyframes[i].tick == tick)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void PushSnapshot(SnapshotRing &ring, const World &world)
+{
+    int capacity = (int)ring.snapshots.size();
+    WorldSnapshot &snapshot = ring.snapshots[ring.next];
+
+    bool full = ring.keyframe < 0 || world.tick - ring.keyframes[ring.keyframe].tick >= ring.keyframeInterval ||
+                !SaveWorldDelta(world, ring.keyframes[ring.keyframe], snapshot, ring.deltaBudget);
+    if (full)
+    {
+        SaveWorldSnapshot(world, ring.keyframes[ring.nextKeyframe]);
+        ring.keyframe = ring.nextKeyframe;
+        ring.nextKeyframe = (ring.nextKeyframe + 1) % (int)ring.keyframes.size();
+
+        // The slot only records which keyframe to restore
+        snapshot.tick = world.tick;
+        snapshot.delta = false;
+        snapshot.keyframeTick = world.tick;
+        snapshot.bytes.clear();
+        snapshot.blocks.clear();
+    }
+
+    ring.next = (ring.next + 1) % capacity;
+    ring.count = ring.count < capacity ? ring.count + 1 : capacity;
+}
+
+// Slot holding the snapshot of tick, or -1
+int FindSnapshot(const SnapshotRing &ring, long long tick)
+{
+    int capacity = (int)ring.snapshots.size();
+    for (int age = 0; age < ring.count; ++age)
+    {
+        int slot = (ring.next - 1 - age + capacity) % capacity;
+        if (ring.snapshots[slot].tick == tick)
+        {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+bool RestoreSnapshot(const SnapshotRing &ring, long long tick, World &world)
+{
+    int slot = FindSnapshot(ring, tick);
+    if (slot < 0)
+    {
+        return false;
+    }
+
+    const WorldSnapshot &snapshot = ring.snapshots[slot];
+    int keyframe = FindKeyframe(ring, snapshot.keyframeTick);
+    if (keyframe < 0)
+    {
+        return false;
+    }
+    if (!snapshot.delta)
+    {
+        RestoreWorldSnapshot(world, ring.keyframes[keyframe]);
+        return true;
+    }
+    RestoreWorldDelta(world, ring.keyframes[keyframe], snapshot);
+    return true;
+}
+
+void TruncateSnapshots(SnapshotRing &ring, long long tick)
+{
+    int capacity = (int)ring.snapshots.size();
+    while (ring.count > 0 && ring.snapshots[(ring.next - 1 + capacity) % capacity].tick > tick)
+    {
+        ring.next = (ring.next - 1 + capacity) % capacity;
+        ring.count--;
+    }
+
+    // Keyframes after tick are freed, newest first, so they are reused before
+    // any older one; the newest remaining one becomes the keyframe again
+    int keyframes = (int)ring.keyframes.size();
+    ring.keyframe = -1;
+    for (int age = 0; age < keyframes && ring.keyframe < 0; ++age)
+    {
+        int slot = (ring.nextKeyframe - 1 - age + keyframes) % keyframes;
+        if (ring.keyframes[slot].tick > tick)
+        {
+            ring.keyframes[slot].tick = -1;
+            ring.nextKeyframe = slot;
+        }
+        else if (ring.keyframes[slot].tick >= 0)
+        {
+            ring.keyframe = slot;
+        }
+    }
+}
+
+// Snapshots older than the oldest keyframe have lost it
+long long OldestSnapshotTick(const SnapshotRing &ring)
+{
+    int capacity = (int)ring.snapshots.size();
+    for (int age = ring.count - 1; age >= 0; --age)
+    {
+        const WorldSnapshot &snapshot = ring.snapshots[(ring.next - 1 - age + capacity) % capacity];
+        if (FindKeyframe(ring, snapshot.keyframeTick) >= 0)
+        {
+            return snapshot.tick;
+        }
+    }
+    return -1;
+}
+
+long long NewestSnapshotTick(const SnapshotRing &ring)
+{
+    int capacity = (int)ring.snapshots.size();
+    return ring.count > 0 ? ring.snapshots[(ring.next - 1 + capacity) % capacity].tick : -1;
+}
@@ -0,0 +1,81 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "Simulation.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Copies of the gameplay state of a world, for rewinding and rollback.
+//
+// A snapshot is a flat byte image of the world's state split into sections:
+// the scalar state, then every entity column, the enemy handle table, the
+// emitters and the timer wheel, each copied with one memcpy. A delta
+// snapshot only keeps the snapshotBlockSize blocks of each section that
+// differ from a full one (its keyframe), which drops the columns that rarely
+// change such as radius, color and most velocities.
+//
+// Restoring sets everything ChecksumWorld covers; kernels, jobs and the
+// phase timers are left alone and the grid is rebuilt by the next step.
+// Buffers keep their capacity, so once a ring has seen the largest world it
+// saves and restores without allocating.
+
+const int snapshotBlockSize = 4096;
+const int snapshotSectionCount = 24;
+// Most bytes a ring keeps for one delta, so a long ring of a large world
+// costs a full image per keyframe rather than per tick
+const size_t snapshotDeltaBudget = 256 * 1024;
+
+struct WorldSnapshot
+{
+    long long tick;
+    bool delta;
+    long long keyframeTick;                       // delta only, tick of the full snapshot it applies to
+    uint32_t sectionSizes[snapshotSectionCount];  // bytes of each section of the world
+    std::vector<unsigned char> bytes;             // sections back to back, or the changed blocks
+    std::vector<uint32_t> blocks;                 // delta only: section << 24 | block, in bytes order
+};
+
+// The last capacity ticks. Each tick's slot holds a delta of at most
+// deltaBudget bytes, or stands in for a full snapshot kept in the keyframes
+// pool. A full snapshot is taken every keyframeInterval ticks, and instead of
+// any delta that would go over budget; the oldest keyframe is overwritten
+// first, which retires the deltas built on it. Only the keyframes are
+// reserved for a whole world, so a world whose every delta is over budget
+// keeps as many ticks as there are keyframes.
+struct SnapshotRing
+{
+    std::vector<WorldSnapshot> snapshots;
+    std::vector<WorldSnapshot> keyframes;
+    int keyframeInterval;
+    size_t deltaBudget;
+    int next;  // slot the next snapshot goes into
+    int count;
+    int keyframe;     // keyframe the next delta applies to, or -1
+    int nextKeyframe; // keyframe slot the next full snapshot goes into
+};
+
+void SaveWorldSnapshot(const World &world, WorldSnapshot &snapshot);
+// False, leaving snapshot unusable, if the changed blocks come to more than
+// budget bytes
+bool SaveWorldDelta(const World &world, const WorldSnapshot &keyframe, WorldSnapshot &snapshot, size_t budget);
+void RestoreWorldSnapshot(World &world, const WorldSnapshot &snapshot);
+// keyframe is only read for delta snapshots
+void RestoreWorldDelta(World &world, const WorldSnapshot &keyframe, const WorldSnapshot &snapshot);
+
+// Reserves the keyframes for a world the size of world, and the delta slots
+// for as much of it as fits in snapshotDeltaBudget
+void InitSnapshotRing(SnapshotRing &ring, const World &world, int capacity, int keyframeInterval);
+// Saves world as the newest snapshot, overwriting the oldest when full
+void PushSnapshot(SnapshotRing &ring, const World &world);
+// Restores the snapshot taken at tick; false if it is gone or its keyframe
+// has been overwritten
+bool RestoreSnapshot(const SnapshotRing &ring, long long tick, World &world);
+// Drops every snapshot after tick, so pushing continues from there
+void TruncateSnapshots(SnapshotRing &ring, long long tick);
+
+// Range of ticks that can currently be restored, -1 when empty
+long long OldestSnapshotTick(const SnapshotRing &ring);
+long long NewestSnapshotTick(const SnapshotRing &ring);
+
+#endif
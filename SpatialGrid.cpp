@@ -0,0 +1,46 @@
+#include "SpatialGrid.h"
+
+void InitSpatialGrid(SpatialGrid &grid, float width, float height, float maxRadius)
+{
+    // Cells twice the largest radius keep most queries to a 3x3 block
+    grid.cellSize = 2.0f * maxRadius;
+    grid.maxRadius = maxRadius;
+    grid.columns = (int)(width / grid.cellSize) + 1;
+    grid.rows = (int)(height / grid.cellSize) + 1;
+    grid.cellStart.assign(grid.columns * grid.rows + 1, 0);
+    grid.cellItems.clear();
+    grid.itemCells.clear();
+}
+
+void BuildSpatialGrid(SpatialGrid &grid, int itemCount)
+{
+    int cellCount = grid.columns * grid.rows;
+    grid.cellItems.resize(itemCount);
+
+    // Count items per cell
+    grid.cellStart.assign(cellCount + 1, 0);
+    for (int i = 0; i < itemCount; ++i)
+    {
+        grid.cellStart[grid.itemCells[i] + 1]++;
+    }
+
+    // Turn counts into offsets
+    for (int cell = 0; cell < cellCount; ++cell)
+    {
+        grid.cellStart[cell + 1] += grid.cellStart[cell];
+    }
+
+    // Scatter, keeping items in index order inside each cell
+    for (int i = 0; i < itemCount; ++i)
+    {
+        int cell = grid.itemCells[i];
+        grid.cellItems[grid.cellStart[cell]++] = i;
+    }
+
+    // Scattering advanced each start to the next cell's start; shift back
+    for (int cell = cellCount; cell > 0; --cell)
+    {
+        grid.cellStart[cell] = grid.cellStart[cell - 1];
+    }
+    grid.cellStart[0] = 0;
+}
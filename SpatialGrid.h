@@ -0,0 +1,63 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <vector>
+
+// Uniform grid broadphase over the screen. Items are bucketed by the cell of
+// their center with a counting sort, so a rebuild is O(items + cells) and
+// reuses its buffers. Queries only visit the cells a circle can touch.
+struct SpatialGrid
+{
+    float cellSize;
+    float maxRadius;
+    int columns;
+    int rows;
+    std::vector<int> cellStart; // columns * rows + 1 offsets into cellItems
+    std::vector<int> cellItems; // item indices sorted by cell
+    std::vector<int> itemCells; // cell of each item, filled by the caller
+};
+
+void InitSpatialGrid(SpatialGrid &grid, float width, float height, float maxRadius);
+void BuildSpatialGrid(SpatialGrid &grid, int itemCount);
+
+inline int SpatialGridColumn(const SpatialGrid &grid, float x)
+{
+    int column = (int)(x / grid.cellSize);
+    return column < 0 ? 0 : (column >= grid.columns ? grid.columns - 1 : column);
+}
+
+inline int SpatialGridRow(const SpatialGrid &grid, float y)
+{
+    int row = (int)(y / grid.cellSize);
+    return row < 0 ? 0 : (row >= grid.rows ? grid.rows - 1 : row);
+}
+
+inline int SpatialGridCell(const SpatialGrid &grid, float x, float y)
+{
+    return SpatialGridRow(grid, y) * grid.columns + SpatialGridColumn(grid, x);
+}
+
+// Calls visit(item) for every item whose circle may overlap the given circle
+template <typename Visit>
+void QuerySpatialGrid(const SpatialGrid &grid, float x, float y, float radius, Visit visit)
+{
+    float reach = radius + grid.maxRadius;
+    int minColumn = SpatialGridColumn(grid, x - reach);
+    int maxColumn = SpatialGridColumn(grid, x + reach);
+    int minRow = SpatialGridRow(grid, y - reach);
+    int maxRow = SpatialGridRow(grid, y + reach);
+
+    for (int row = minRow; row <= maxRow; ++row)
+    {
+        for (int column = minColumn; column <= maxColumn; ++column)
+        {
+            int cell = row * grid.columns + column;
+            for (int i = grid.cellStart[cell]; i < grid.cellStart[cell + 1]; ++i)
+            {
+                visit(grid.cellItems[i]);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,183 @@
+#include "TimerWheel.h"
+
+void InitTimerWheel(TimerWheel &wheel, long long now)
+{
+    wheel.now = now;
+    wheel.timers.clear();
+    wheel.freeTimers.clear();
+    for (int slot = 0; slot < timerWheelLevels * timerWheelSlots; ++slot)
+    {
+        wheel.lists.heads[slot] = -1;
+        wheel.lists.tails[slot] = -1;
+    }
+}
+
+void ClearTimerWheel(TimerWheel &wheel)
+{
+    for (int slot = 0; slot < timerWheelLevels * timerWheelSlots; ++slot)
+    {
+        for (int index = wheel.lists.heads[slot]; index >= 0; index = wheel.timers[index].next)
+        {
+            wheel.timers[index].slot = -1;
+            wheel.timers[index].generation++;
+            wheel.freeTimers.push_back(index);
+        }
+        wheel.lists.heads[slot] = -1;
+        wheel.lists.tails[slot] = -1;
+    }
+}
+
+// Slot for a timer due at due, as seen from now
+int TimerSlot(long long now, long long due)
+{
+    long long delta = due - now;
+    for (int level = 0; level < timerWheelLevels - 1; ++level)
+    {
+        if (delta < (1ll << (timerWheelBits * (level + 1))))
+        {
+            return level * timerWheelSlots + (int)((due >> (timerWheelBits * level)) & (timerWheelSlots - 1));
+        }
+    }
+
+    // Past the top level's span it waits in the furthest slot and comes down
+    // a little further each time round
+    const int top = timerWheelLevels - 1;
+    long long span = 1ll << (timerWheelBits * timerWheelLevels);
+    long long capped = delta < span ? due : now + span - 1;
+    return top * timerWheelSlots + (int)((capped >> (timerWheelBits * top)) & (timerWheelSlots - 1));
+}
+
+void LinkTimer(TimerWheel &wheel, int index, int slot)
+{
+    Timer &timer = wheel.timers[index];
+    timer.slot = slot;
+    timer.next = -1;
+    timer.prev = wheel.lists.tails[slot];
+    if (timer.prev >= 0)
+    {
+        wheel.timers[timer.prev].next = index;
+    }
+    else
+    {
+        wheel.lists.heads[slot] = index;
+    }
+    wheel.lists.tails[slot] = index;
+}
+
+void UnlinkTimer(TimerWheel &wheel, int index)
+{
+    Timer &timer = wheel.timers[index];
+    if (timer.prev >= 0)
+    {
+        wheel.timers[timer.prev].next = timer.next;
+    }
+    else
+    {
+        wheel.lists.heads[timer.slot] = timer.next;
+    }
+    if (timer.next >= 0)
+    {
+        wheel.timers[timer.next].prev = timer.prev;
+    }
+    else
+    {
+        wheel.lists.tails[timer.slot] = timer.prev;
+    }
+    timer.slot = -1;
+}
+
+TimerHandle ScheduleTimer(TimerWheel &wheel, long long due, int kind, uint64_t data)
+{
+    int index;
+    if (!wheel.freeTimers.empty())
+    {
+        index = wheel.freeTimers.back();
+        wheel.freeTimers.pop_back();
+    }
+    else
+    {
+        index = (int)wheel.timers.size();
+        wheel.timers.push_back(Timer{});
+        wheel.timers[index].generation = 1;
+    }
+
+    Timer &timer = wheel.timers[index];
+    timer.due = due > wheel.now ? due : wheel.now + 1;
+    timer.kind = kind;
+    timer.data = data;
+    LinkTimer(wheel, index, TimerSlot(wheel.now, timer.due));
+    return {index, timer.generation};
+}
+
+bool IsTimerPending(const TimerWheel &wheel, TimerHandle handle)
+{
+    return handle.index >= 0 && handle.index < (int)wheel.timers.size() &&
+           wheel.timers[handle.index].generation == handle.generation && wheel.timers[handle.index].slot >= 0;
+}
+
+bool CancelTimer(TimerWheel &wheel, TimerHandle handle)
+{
+    if (!IsTimerPending(wheel, handle))
+    {
+        return false;
+    }
+    UnlinkTimer(wheel, handle.index);
+    wheel.timers[handle.index].generation++;
+    wheel.freeTimers.push_back(handle.index);
+    return true;
+}
+
+long long TimerDue(const TimerWheel &wheel, TimerHandle handle)
+{
+    return IsTimerPending(wheel, handle) ? wheel.timers[handle.index].due : -1;
+}
+
+// Moves every timer of a slot down to the slot it belongs in now
+void CascadeSlot(TimerWheel &wheel, int slot)
+{
+    int index = wheel.lists.heads[slot];
+    wheel.lists.heads[slot] = -1;
+    wheel.lists.tails[slot] = -1;
+    while (index >= 0)
+    {
+        int next = wheel.timers[index].next;
+        LinkTimer(wheel, index, TimerSlot(wheel.now, wheel.timers[index].due));
+        index = next;
+    }
+}
+
+void AdvanceTimerWheel(TimerWheel &wheel, long long tick, std::vector<TimerEvent> &fired)
+{
+    while (wheel.now < tick)
+    {
+        long long now = ++wheel.now;
+
+        // When a level wraps, the next slot of the level above comes down;
+        // higher levels first so their timers can fall through
+        int wrapped = 0;
+        while (wrapped + 1 < timerWheelLevels && ((now >> (timerWheelBits * (wrapped + 1))) << (timerWheelBits * (wrapped + 1))) == now)
+        {
+            wrapped++;
+        }
+        for (int level = wrapped; level > 0; --level)
+        {
+            CascadeSlot(wheel, level * timerWheelSlots + (int)((now >> (timerWheelBits * level)) & (timerWheelSlots - 1)));
+        }
+
+        // Everything left in this level 0 slot is due now
+        int slot = (int)(now & (timerWheelSlots - 1));
+        int index = wheel.lists.heads[slot];
+        wheel.lists.heads[slot] = -1;
+        wheel.lists.tails[slot] = -1;
+        while (index >= 0)
+        {
+            Timer &timer = wheel.timers[index];
+            int next = timer.next;
+            fired.push_back({timer.kind, timer.data});
+            timer.slot = -1;
+            timer.generation++;
+            wheel.freeTimers.push_back(index);
+            index = next;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timer wheel counted in simulation ticks. Level 0 has one slot
+// per tick for the next 64 ticks, each level above covers 64 times the span
+// of the one below, and a timer moves down a level each time its slot comes
+// round, so four levels reach 2^24 ticks (three days at 60 ticks a second).
+// Scheduling and cancelling unlink or link one list node, and advancing a
+// tick only touches the timers that are due or move down a level; idle
+// timers are never scanned.
+//
+// Timers live in a pool and carry a kind and a payload for the caller to
+// dispatch on. Everything is plain data, so a wheel can be snapshotted.
+
+const int timerWheelBits = 6;
+const int timerWheelSlots = 1 << timerWheelBits;
+const int timerWheelLevels = 4;
+
+struct TimerHandle
+{
+    int index;
+    uint32_t generation;
+};
+
+const TimerHandle nullTimerHandle = {-1, 0};
+
+struct Timer
+{
+    long long due; // tick it fires on
+    int kind;
+    uint64_t data;
+    int next;      // neighbors in its slot list, -1 at the ends
+    int prev;
+    int slot;      // list it is in, -1 when free
+    uint32_t generation;
+};
+
+struct TimerEvent
+{
+    int kind;
+    uint64_t data;
+};
+
+// Slot list ends, one list per slot of every level
+struct TimerLists
+{
+    int heads[timerWheelLevels * timerWheelSlots];
+    int tails[timerWheelLevels * timerWheelSlots];
+};
+
+struct TimerWheel
+{
+    long long now; // last tick advanced to
+    TimerLists lists;
+    std::vector<Timer> timers;
+    std::vector<int> freeTimers;
+};
+
+void InitTimerWheel(TimerWheel &wheel, long long now);
+// Cancels every timer; handles to them stop resolving
+void ClearTimerWheel(TimerWheel &wheel);
+
+// Fires on tick due, or on the next tick advanced to if due has passed
+TimerHandle ScheduleTimer(TimerWheel &wheel, long long due, int kind, uint64_t data);
+// False if the timer already fired or was cancelled
+bool CancelTimer(TimerWheel &wheel, TimerHandle handle);
+// Tick the timer fires on, or -1 if it is not pending
+long long TimerDue(const TimerWheel &wheel, TimerHandle handle);
+
+// Advances to tick, appending the timers that fire to fired in tick order. The
+// order within a tick only depends on the wheel's history, so it replays.
+void AdvanceTimerWheel(TimerWheel &wheel, long long tick, std::vector<TimerEvent> &fired);
+
+#endif
@@ -0,0 +1,497 @@
+#include "../Simulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Runs scripted scenarios headlessly and reports tick time percentiles, per
+// phase and overall, plus entity throughput and peak RSS, as JSON. Each
+// scenario runs in its own child process where fork is available, so its peak
+// RSS is its own and not the largest of every scenario run before it.
+// Usage: bench [--scenario NAME]... [--ticks N] [--threads N] [--out FILE]
+//              [--compare BASELINE.json] [--threshold PERCENT]
+// With --compare, exits non-zero if any scenario's median tick time grew by
+// more than the threshold (default 10%) against the baseline file, or if a
+// scenario is in only one of the baseline and this run.
+
+enum ScenarioLayout
+{
+    LAYOUT_UNIFORM, // random positions and speeds, as the game spawns them
+    LAYOUT_CLUSTER, // every enemy inside a small box around the center
+    LAYOUT_OVERLAP  // every enemy on the same point, all in one grid cell, re-stacked
+                    // every tick so separation steering cannot spread them out
+};
+
+struct Scenario
+{
+    const char *name;
+    int enemies;
+    int bulletsPerVolley;
+    float volleyInterval;
+    ScenarioLayout layout;
+};
+
+const Scenario scenarios[] = {
+    {"baseline", maxEnemies, 8, 0.7f, LAYOUT_UNIFORM},
+    {"uniform-10k-1k", 10000, 1000, 0.1f, LAYOUT_UNIFORM},
+    {"uniform-100k-5k", 100000, 5000, 0.1f, LAYOUT_UNIFORM},
+    {"cluster-20k-2k", 20000, 2000, 0.1f, LAYOUT_CLUSTER},
+    {"overlap-5k-500", 5000, 500, 0.1f, LAYOUT_OVERLAP},
+};
+
+struct Percentiles
+{
+    double p50;
+    double p95;
+    double p99;
+};
+
+struct ScenarioResult
+{
+    std::string name;
+    int enemies;
+    long ticks;
+    double averageBullets;
+    double entitiesPerSecond;
+    Percentiles tick;
+    Percentiles phases[PHASE_COUNT];
+    long peakRssKb;
+};
+
+ScenarioResult RunScenario(const Scenario &scenario, long ticks, int threads);
+ScenarioResult RunScenarioIsolated(const Scenario &scenario, long ticks, int threads);
+Percentiles ComputePercentiles(std::vector<double> &samples);
+long PeakRssKb();
+void WriteJson(FILE *file, const std::vector<ScenarioResult> &results);
+bool ReadBaselineMedian(const std::string &json, const std::string &name, double &median);
+std::vector<std::string> ReadBaselineNames(const std::string &json);
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> selected;
+    long ticks = 600;
+    int threads = 0;
+    const char *outPath = nullptr;
+    const char *comparePath = nullptr;
+    double threshold = 10.0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--scenario") == 0)
+        {
+            bool known = false;
+            for (const Scenario &scenario : scenarios)
+            {
+                known = known || std::strcmp(scenario.name, argv[i + 1]) == 0;
+            }
+            if (!known)
+            {
+                std::fprintf(stderr, "unknown scenario '%s', expected one of:\n", argv[i + 1]);
+                for (const Scenario &scenario : scenarios)
+                {
+                    std::fprintf(stderr, "  %s\n", scenario.name);
+                }
+                return 1;
+            }
+            selected.push_back(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--ticks") == 0)
+        {
+            ticks = std::atol(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0)
+        {
+            threads = std::atoi(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--out") == 0)
+        {
+            outPath = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--compare") == 0)
+        {
+            comparePath = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--threshold") == 0)
+        {
+            threshold = std::atof(argv[i + 1]);
+        }
+    }
+
+    std::vector<ScenarioResult> results;
+    for (const Scenario &scenario : scenarios)
+    {
+        if (selected.empty() || std::find(selected.begin(), selected.end(), scenario.name) != selected.end())
+        {
+            std::fprintf(stderr, "running %s\n", scenario.name);
+            results.push_back(RunScenarioIsolated(scenario, ticks, threads));
+        }
+    }
+
+    FILE *out = outPath ? std::fopen(outPath, "w") : stdout;
+    if (!out)
+    {
+        std::fprintf(stderr, "cannot write '%s'\n", outPath);
+        return 1;
+    }
+    WriteJson(out, results);
+    if (outPath)
+    {
+        std::fclose(out);
+    }
+
+    if (!comparePath)
+    {
+        return 0;
+    }
+
+    // Compare median tick times against the baseline
+    std::string baseline;
+    FILE *file = std::fopen(comparePath, "rb");
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot read '%s'\n", comparePath);
+        return 1;
+    }
+    char buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        baseline.append(buffer, read);
+    }
+    std::fclose(file);
+
+    // A scenario missing from either side fails rather than passing unseen
+    int regressions = 0;
+    for (const ScenarioResult &result : results)
+    {
+        double median;
+        if (!ReadBaselineMedian(baseline, result.name, median) || median <= 0.0)
+        {
+            std::fprintf(stderr, "%-18s not in baseline  MISSING\n", result.name.c_str());
+            ++regressions;
+            continue;
+        }
+
+        double change = 100.0 * (result.tick.p50 - median) / median;
+        bool regressed = change > threshold;
+        regressions += regressed ? 1 : 0;
+        std::fprintf(stderr, "%-18s p50 %.4f ms -> %.4f ms (%+.1f%%)%s\n", result.name.c_str(), median,
+                     result.tick.p50, change, regressed ? "  REGRESSION" : "");
+    }
+    for (const std::string &name : ReadBaselineNames(baseline))
+    {
+        bool wanted = selected.empty() || std::find(selected.begin(), selected.end(), name) != selected.end();
+        bool ran = false;
+        for (const ScenarioResult &result : results)
+        {
+            ran = ran || result.name == name;
+        }
+        if (wanted && !ran)
+        {
+            std::fprintf(stderr, "%-18s not in this run  MISSING\n", name.c_str());
+            ++regressions;
+        }
+    }
+    return regressions > 0 ? 1 : 0;
+}
+
+// Places enemies first and up according to the layout
+void ApplyLayout(World &world, int first, ScenarioLayout layout)
+{
+    EntityArrays &enemies = world.enemies;
+    for (int i = first; i < enemies.count && layout != LAYOUT_UNIFORM; ++i)
+    {
+        if (layout == LAYOUT_CLUSTER)
+        {
+            enemies.x[i] = screenWidth / 2 + RandomValue(world.rng, -100, 100);
+            enemies.y[i] = screenHeight / 2 + RandomValue(world.rng, -100, 100);
+        }
+        else
+        {
+            enemies.x[i] = screenWidth / 2;
+            enemies.y[i] = screenHeight / 2;
+            enemies.vx[i] = 0.0f;
+            enemies.vy[i] = 0.0f;
+        }
+    }
+}
+
+ScenarioResult RunScenario(const Scenario &scenario, long ticks, int threads)
+{
+    static World world;
+    InitWorld(world, scenario.enemies, 1);
+    // Waves would keep adding enemies on top of the scenario's count
+    CancelTimer(world.timers, world.waveTimer);
+    ApplyLayout(world, 0, scenario.layout);
+    Emitter emitter = MakeEmitter(EMITTER_SPIRAL, scenario.bulletsPerVolley, 300.0f, 4.0f, scenario.volleyInterval, colorDarkGray);
+    emitter.spin = 0.05f;
+    ClearEmitters(world);
+    AddEmitter(world, emitter);
+
+    JobSystem *jobs = CreateJobSystem(threads);
+    world.jobs = jobs;
+    double phaseSeconds[PHASE_COUNT] = {0};
+    world.phaseSeconds = phaseSeconds;
+
+    std::vector<double> tickSamples;
+    std::vector<double> phaseSamples[PHASE_COUNT];
+    tickSamples.reserve(ticks);
+    double totalSeconds = 0.0;
+    double entityTicks = 0.0;
+    double bulletTicks = 0.0;
+
+    // Player stands still and never restarts. Killed enemies are replaced
+    // between ticks, so the load stays at the scenario's enemy count, and
+    // overlapping enemies are stacked again, so it stays the worst case.
+    InputFrame input = {0};
+    for (long tick = 0; tick < ticks; ++tick)
+    {
+        auto start = std::chrono::steady_clock::now();
+        StepWorld(world, simDt, input);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        totalSeconds += seconds;
+        tickSamples.push_back(1000.0 * seconds);
+        for (int phase = 0; phase < PHASE_COUNT; ++phase)
+        {
+            phaseSamples[phase].push_back(1000.0 * phaseSeconds[phase]);
+        }
+        entityTicks += world.enemies.count + world.bullets.count;
+        bulletTicks += world.bullets.count;
+
+        int killed = scenario.enemies - world.enemies.count;
+        if (killed > 0)
+        {
+            ApplyLayout(world, SpawnEnemies(world, killed), scenario.layout);
+        }
+        if (scenario.layout == LAYOUT_OVERLAP)
+        {
+            ApplyLayout(world, 0, scenario.layout);
+        }
+    }
+
+    world.phaseSeconds = nullptr;
+    world.jobs = nullptr;
+    DestroyJobSystem(jobs);
+
+    ScenarioResult result;
+    result.name = scenario.name;
+    result.enemies = scenario.enemies;
+    result.ticks = ticks;
+    result.averageBullets = ticks > 0 ? bulletTicks / ticks : 0.0;
+    result.entitiesPerSecond = totalSeconds > 0.0 ? entityTicks / totalSeconds : 0.0;
+    result.tick = ComputePercentiles(tickSamples);
+    for (int phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+        result.phases[phase] = ComputePercentiles(phaseSamples[phase]);
+    }
+    result.peakRssKb = PeakRssKb();
+    return result;
+}
+
+#ifdef _WIN32
+ScenarioResult RunScenarioIsolated(const Scenario &scenario, long ticks, int threads)
+{
+    return RunScenario(scenario, ticks, threads);
+}
+#else
+template <typename T> void WriteValue(int fd, const T &value)
+{
+    const char *bytes = (const char *)&value;
+    for (size_t done = 0; done < sizeof(T);)
+    {
+        ssize_t written = write(fd, bytes + done, sizeof(T) - done);
+        if (written <= 0)
+        {
+            return;
+        }
+        done += (size_t)written;
+    }
+}
+
+template <typename T> bool ReadValue(int fd, T &value)
+{
+    char *bytes = (char *)&value;
+    for (size_t done = 0; done < sizeof(T);)
+    {
+        ssize_t got = read(fd, bytes + done, sizeof(T) - done);
+        if (got <= 0)
+        {
+            return false;
+        }
+        done += (size_t)got;
+    }
+    return true;
+}
+
+// Runs the scenario in a forked child, which sends its numbers back through
+// a pipe, and takes the peak RSS from the child's own rusage. Falls back to
+// running in this process if the child cannot be started.
+ScenarioResult RunScenarioIsolated(const Scenario &scenario, long ticks, int threads)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return RunScenario(scenario, ticks, threads);
+    }
+    std::fflush(nullptr);
+    pid_t child = fork();
+    if (child < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return RunScenario(scenario, ticks, threads);
+    }
+
+    if (child == 0)
+    {
+        close(fds[0]);
+        ScenarioResult result = RunScenario(scenario, ticks, threads);
+        WriteValue(fds[1], result.averageBullets);
+        WriteValue(fds[1], result.entitiesPerSecond);
+        WriteValue(fds[1], result.tick);
+        WriteValue(fds[1], result.phases);
+        close(fds[1]);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    ScenarioResult result = {};
+    result.name = scenario.name;
+    result.enemies = scenario.enemies;
+    result.ticks = ticks;
+    bool complete = ReadValue(fds[0], result.averageBullets) && ReadValue(fds[0], result.entitiesPerSecond) &&
+                    ReadValue(fds[0], result.tick) && ReadValue(fds[0], result.phases);
+    close(fds[0]);
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) == child)
+    {
+#ifdef __APPLE__
+        result.peakRssKb = usage.ru_maxrss / 1024;
+#else
+        result.peakRssKb = usage.ru_maxrss;
+#endif
+    }
+    if (!complete || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::fprintf(stderr, "%s did not finish\n", scenario.name);
+        std::exit(1);
+    }
+    return result;
+}
+#endif
+
+// Nearest-rank percentiles
+Percentiles ComputePercentiles(std::vector<double> &samples)
+{
+    Percentiles percentiles = {0.0, 0.0, 0.0};
+    if (samples.empty())
+    {
+        return percentiles;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    size_t last = samples.size() - 1;
+    percentiles.p50 = samples[(size_t)(0.50 * last + 0.5)];
+    percentiles.p95 = samples[(size_t)(0.95 * last + 0.5)];
+    percentiles.p99 = samples[(size_t)(0.99 * last + 0.5)];
+    return percentiles;
+}
+
+// Process high-water mark so far, only the scenario's own when it ran in a
+// child of its own; 0 where unsupported
+long PeakRssKb()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+void WritePercentiles(FILE *file, const char *name, const Percentiles &percentiles)
+{
+    std::fprintf(file, "\"%s\": {\"p50\": %.6f, \"p95\": %.6f, \"p99\": %.6f}", name, percentiles.p50, percentiles.p95,
+                 percentiles.p99);
+}
+
+void WriteJson(FILE *file, const std::vector<ScenarioResult> &results)
+{
+    std::fprintf(file, "{\n  \"scenarios\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const ScenarioResult &result = results[i];
+        std::fprintf(file, "    {\n");
+        std::fprintf(file, "      \"name\": \"%s\",\n", result.name.c_str());
+        std::fprintf(file, "      \"enemies\": %d,\n", result.enemies);
+        std::fprintf(file, "      \"average_bullets\": %.1f,\n", result.averageBullets);
+        std::fprintf(file, "      \"ticks\": %ld,\n", result.ticks);
+        std::fprintf(file, "      \"entities_per_second\": %.0f,\n", result.entitiesPerSecond);
+        std::fprintf(file, "      \"peak_rss_kb\": %ld,\n", result.peakRssKb);
+        std::fprintf(file, "      ");
+        WritePercentiles(file, "tick_ms", result.tick);
+        std::fprintf(file, ",\n      \"phase_ms\": {\n");
+        for (int phase = 0; phase < PHASE_COUNT; ++phase)
+        {
+            std::fprintf(file, "        ");
+            WritePercentiles(file, simPhaseNames[phase], result.phases[phase]);
+            std::fprintf(file, phase + 1 < PHASE_COUNT ? ",\n" : "\n");
+        }
+        std::fprintf(file, "      }\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+}
+
+// Finds "tick_ms": {"p50": X} inside the named scenario of a file written by
+// WriteJson
+bool ReadBaselineMedian(const std::string &json, const std::string &name, double &median)
+{
+    size_t start = json.find("\"name\": \"" + name + "\"");
+    if (start == std::string::npos)
+    {
+        return false;
+    }
+    size_t end = json.find("\"name\":", start + 1);
+    size_t tick = json.find("\"tick_ms\": {\"p50\": ", start);
+    if (tick == std::string::npos || (end != std::string::npos && tick > end))
+    {
+        return false;
+    }
+    median = std::atof(json.c_str() + tick + std::strlen("\"tick_ms\": {\"p50\": "));
+    return true;
+}
+
+// Every scenario name in a file written by WriteJson
+std::vector<std::string> ReadBaselineNames(const std::string &json)
+{
+    std::vector<std::string> names;
+    const std::string key = "\"name\": \"";
+    for (size_t start = json.find(key); start != std::string::npos; start = json.find(key, start))
+    {
+        start += key.size();
+        size_t end = json.find('"', start);
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        names.push_back(json.substr(start, end - start));
+    }
+    return names;
+}
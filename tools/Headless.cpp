@@ -0,0 +1,369 @@
+#include "../Profiler.h"
+#include "../Replay.h"
+#include "../Simulation.h"
+#include "../Snapshot.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Runs the simulation without a window or GPU, driven by a scripted bot or by
+// a recorded replay.
+// Usage: headless [ticks] [enemies] [kernels] [threads]
+//                 [--seed N] [--record FILE] [--checksum-interval N]
+//                 [--trace FILE] (profiler builds, last 10 seconds of the run)
+//                 [--rollback N] (every N ticks, rewind N/2 ticks through the
+//                 snapshot ring, re-simulate and compare checksums)
+//        headless --replay FILE [--threads N]
+//        headless --sweep-check DT (at tick length DT, a bullet leaving the
+//                 screen past an enemy by the wall must still hit it, and so
+//                 must a bullet crossing an enemy's path before it bounces)
+
+struct RollbackStats
+{
+    long saves;
+    long checks;
+    double saveSeconds;
+    double restoreSeconds;
+};
+
+InputFrame BotInput(const World &world, long tick);
+int RunReplay(const char *path, int threads);
+int RunSweepCheck(float dt);
+bool CheckRollback(World &world, SnapshotRing &snapshots, int interval, RollbackStats &stats);
+
+int main(int argc, char *argv[])
+{
+    long ticks = 100000;
+    int enemies = maxEnemies;
+    const char *kernels = nullptr;
+    int threads = 1;
+    uint64_t seed = 1;
+    const char *recordPath = nullptr;
+    const char *replayPath = nullptr;
+    uint32_t checksumInterval = 60;
+    const char *tracePath = nullptr;
+    int rollbackInterval = 0;
+    float sweepCheckDt = 0.0f;
+
+    int position = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--", 2) == 0 && i + 1 < argc)
+        {
+            const char *option = argv[i];
+            const char *value = argv[++i];
+            if (std::strcmp(option, "--seed") == 0)
+            {
+                seed = std::strtoull(value, nullptr, 10);
+            }
+            else if (std::strcmp(option, "--record") == 0)
+            {
+                recordPath = value;
+            }
+            else if (std::strcmp(option, "--replay") == 0)
+            {
+                replayPath = value;
+            }
+            else if (std::strcmp(option, "--threads") == 0)
+            {
+                threads = std::atoi(value);
+            }
+            else if (std::strcmp(option, "--checksum-interval") == 0)
+            {
+                checksumInterval = (uint32_t)std::atoi(value);
+            }
+            else if (std::strcmp(option, "--trace") == 0)
+            {
+                tracePath = value;
+            }
+            else if (std::strcmp(option, "--rollback") == 0)
+            {
+                rollbackInterval = std::atoi(value);
+            }
+            else if (std::strcmp(option, "--sweep-check") == 0)
+            {
+                sweepCheckDt = (float)std::atof(value);
+            }
+            continue;
+        }
+
+        switch (position++)
+        {
+        case 0:
+            ticks = std::atol(argv[i]);
+            break;
+        case 1:
+            enemies = std::atoi(argv[i]);
+            break;
+        case 2:
+            kernels = argv[i];
+            break;
+        case 3:
+            threads = std::atoi(argv[i]);
+            break;
+        }
+    }
+
+    if (replayPath)
+    {
+        return RunReplay(replayPath, threads);
+    }
+    if (sweepCheckDt > 0.0f)
+    {
+        return RunSweepCheck(sweepCheckDt);
+    }
+
+    static World world;
+    InitWorld(world, enemies, seed);
+    if (kernels)
+    {
+        world.kernels = FindEntityKernels(kernels);
+        if (!world.kernels)
+        {
+            std::fprintf(stderr, "kernels '%s' not supported on this CPU\n", kernels);
+            return 1;
+        }
+    }
+    JobSystem *jobs = CreateJobSystem(threads);
+    threads = GetJobThreadCount(jobs);
+    world.jobs = jobs;
+
+    ReplayRecorder recorder = {};
+    if (recordPath && !OpenReplayRecorder(recorder, recordPath, {seed, enemies, checksumInterval}))
+    {
+        std::fprintf(stderr, "cannot write replay '%s'\n", recordPath);
+        return 1;
+    }
+
+    SnapshotRing snapshots;
+    if (rollbackInterval > 0)
+    {
+        InitSnapshotRing(snapshots, world, rollbackInterval, 60);
+    }
+    RollbackStats rollback = {0, 0, 0.0, 0.0};
+
+    auto start = std::chrono::steady_clock::now();
+    for (long tick = 0; tick < ticks; ++tick)
+    {
+        InputFrame input = BotInput(world, tick);
+        StepWorld(world, simDt, input);
+        if (recorder.file)
+        {
+            RecordTick(recorder, input, world);
+        }
+        if (rollbackInterval > 0 && !CheckRollback(world, snapshots, rollbackInterval, rollback))
+        {
+            std::printf("rollback diverged at tick %lld\n", world.tick);
+            return 1;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    CloseReplayRecorder(recorder);
+    DestroyJobSystem(jobs);
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("ticks: %ld enemies: %d kernels: %s threads: %d\n", ticks, enemies, world.kernels->name, threads);
+    std::printf("seconds: %.3f\n", seconds);
+    std::printf("ticks per second: %.0f\n", seconds > 0.0 ? ticks / seconds : 0.0);
+    std::printf("level: %d exp: %d hp: %d stage: %d enemies: %d\n", world.player.lvl, world.player.exp, world.player.hp,
+                world.currentLevel, world.enemies.count);
+    std::printf("checksum: %016llx\n", (unsigned long long)ChecksumWorld(world));
+    if (rollbackInterval > 0)
+    {
+        std::printf("rollbacks: %ld snapshot save: %.2f us restore: %.2f us\n", rollback.checks,
+                    rollback.saveSeconds * 1e6 / (rollback.saves > 0 ? rollback.saves : 1),
+                    rollback.restoreSeconds * 1e6 / (rollback.checks > 0 ? rollback.checks : 1));
+    }
+
+#ifdef ENABLE_PROFILER
+    if (tracePath && !WriteChromeTrace(tracePath, 10.0))
+    {
+        std::fprintf(stderr, "cannot write trace '%s'\n", tracePath);
+        return 1;
+    }
+#else
+    if (tracePath)
+    {
+        std::fprintf(stderr, "--trace needs a profiler build (make PROFILER=TRUE)\n");
+    }
+#endif
+    return 0;
+}
+
+// Replays a recording as fast as possible, stopping at the first checkpoint
+// whose checksum does not match
+int RunReplay(const char *path, int threads)
+{
+    ReplayReader reader;
+    if (!OpenReplayReader(reader, path))
+    {
+        std::fprintf(stderr, "cannot read replay '%s'\n", path);
+        return 1;
+    }
+
+    static World world;
+    InitWorld(world, reader.header.enemyCount, reader.header.seed);
+    JobSystem *jobs = CreateJobSystem(threads);
+    world.jobs = jobs;
+
+    int result = 0;
+    long checkpoints = 0;
+    InputFrame input;
+    auto start = std::chrono::steady_clock::now();
+    while (ReadReplayInput(reader, input))
+    {
+        StepWorld(world, simDt, input);
+
+        uint64_t expected;
+        if (ReadReplayChecksum(reader, world.tick, expected))
+        {
+            checkpoints++;
+            uint64_t actual = ChecksumWorld(world);
+            if (actual != expected)
+            {
+                std::printf("diverged at tick %lld: expected %016llx, got %016llx\n", world.tick,
+                            (unsigned long long)expected, (unsigned long long)actual);
+                result = 1;
+                break;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    DestroyJobSystem(jobs);
+    CloseReplayReader(reader);
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("replayed ticks: %lld checkpoints: %ld\n", world.tick, checkpoints);
+    std::printf("seconds: %.3f\n", seconds);
+    std::printf("ticks per second: %.0f\n", seconds > 0.0 ? world.tick / seconds : 0.0);
+    std::printf("checksum: %016llx\n", (unsigned long long)ChecksumWorld(world));
+    return result;
+}
+
+// Saves the world after every tick. Every interval ticks it goes back half an
+// interval, steps forward again and checks it arrives at the same world.
+bool CheckRollback(World &world, SnapshotRing &snapshots, int interval, RollbackStats &stats)
+{
+    auto saveStart = std::chrono::steady_clock::now();
+    PushSnapshot(snapshots, world);
+    stats.saveSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - saveStart).count();
+    stats.saves++;
+
+    long long now = world.tick;
+    long long back = now - interval / 2;
+    if (now % interval != 0 || back < OldestSnapshotTick(snapshots))
+    {
+        return true;
+    }
+
+    uint64_t expected = ChecksumWorld(world);
+    auto restoreStart = std::chrono::steady_clock::now();
+    if (!RestoreSnapshot(snapshots, back, world))
+    {
+        return false;
+    }
+    stats.restoreSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - restoreStart).count();
+    stats.checks++;
+
+    // The bot reads the tick before it is stepped
+    while (world.tick < now)
+    {
+        StepWorld(world, simDt, BotInput(world, (long)world.tick));
+    }
+    return ChecksumWorld(world) == expected;
+}
+
+// Walk in a square, dash every second and restart when dead
+InputFrame BotInput(const World &world, long tick)
+{
+    const unsigned int directions[4] = {INPUT_RIGHT, INPUT_DOWN, INPUT_LEFT, INPUT_UP};
+    InputFrame input = {directions[(tick / 120) % 4]};
+
+    if (tick % 60 == 0)
+    {
+        input.buttons |= INPUT_DASH;
+    }
+    if (world.player.hp <= 0 && tick % 2 == 0)
+    {
+        input.buttons |= INPUT_RESTART;
+    }
+
+    return input;
+}
+
+// One enemy standing by the right wall and one bullet flying at it. At a
+// long enough tick the bullet ends the tick off screen, where it is culled,
+// and must have hit the enemy on the way.
+bool CheckCulledBulletHit(World &world, float dt)
+{
+    int enemy = SpawnEnemies(world, 1);
+    world.enemies.x[enemy] = 1760.0f;
+    world.enemies.y[enemy] = screenHeight / 2;
+    world.enemies.vx[enemy] = 0.0f;
+    world.enemies.vy[enemy] = 0.0f;
+
+    int bullet = AddEntities(world.bullets, 1);
+    world.bullets.x[bullet] = 1700.0f;
+    world.bullets.y[bullet] = screenHeight / 2;
+    world.bullets.vx[bullet] = 600.0f;
+    world.bullets.vy[bullet] = 0.0f;
+    world.bullets.radius[bullet] = 10.0f;
+    world.bullets.color[bullet] = colorDarkGray;
+    world.bullets.active[bullet] = 1;
+
+    // Until the bullet is spent or gone
+    int ticks = 0;
+    while (world.bullets.count > 0 && ticks < 100)
+    {
+        StepWorld(world, dt, InputFrame{0});
+        ticks++;
+    }
+    return world.enemies.count == 0;
+}
+
+// One enemy chasing the player into the right wall, where it bounces within
+// the tick, and one bullet crossing its path a quarter of the way through.
+// Swept back from its end point along its bounced speed, the enemy would
+// start the tick beyond the wall and the bullet would miss it.
+bool CheckBouncedEnemyHit(World &world, float dt)
+{
+    const float chaseSpeed = 120.0f; // enemies' top speed
+    float travel = chaseSpeed * dt;
+    float y = screenHeight / 2;
+    world.player.position = {screenWidth - world.player.radius, y};
+
+    int enemy = SpawnEnemies(world, 1);
+    float startX = screenWidth - world.enemies.radius[enemy] - 0.75f * travel;
+    world.enemies.x[enemy] = startX;
+    world.enemies.y[enemy] = y;
+    world.enemies.vx[enemy] = chaseSpeed;
+    world.enemies.vy[enemy] = 0.0f;
+
+    int bullet = AddEntities(world.bullets, 1);
+    world.bullets.x[bullet] = startX + 0.25f * travel;
+    world.bullets.y[bullet] = y - 0.25f * 600.0f * dt;
+    world.bullets.vx[bullet] = 0.0f;
+    world.bullets.vy[bullet] = 600.0f;
+    world.bullets.radius[bullet] = 4.0f;
+    world.bullets.color[bullet] = colorDarkGray;
+    world.bullets.active[bullet] = 1;
+
+    StepWorld(world, dt, InputFrame{0});
+    return world.enemies.count == 0;
+}
+
+int RunSweepCheck(float dt)
+{
+    static World world;
+    InitWorld(world, 0, 1);
+    ClearEmitters(world);
+    bool culled = CheckCulledBulletHit(world, dt);
+    std::printf("sweep check at dt %.3f, culled bullet: %s\n", dt, culled ? "hit" : "MISSED");
+
+    InitWorld(world, 0, 1);
+    ClearEmitters(world);
+    bool bounced = CheckBouncedEnemyHit(world, dt);
+    std::printf("sweep check at dt %.3f, bounced enemy: %s\n", dt, bounced ? "hit" : "MISSED");
+    return culled && bounced ? 0 : 1;
+}
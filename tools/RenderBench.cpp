@@ -0,0 +1,151 @@
+#include "../CircleBatch.h"
+#include "raylib.h"
+#include <cstdio>
+#include <cstdlib>
+
+// Draws the same random circles offscreen with per-call DrawCircleV and with
+// both CircleBatch paths, then reports frame times and how many pixels differ.
+// Usage: renderbench [circles] [frames]
+// Without a GPU, run it on Mesa's software rasterizer:
+//   Xvfb :99 & DISPLAY=:99 LIBGL_ALWAYS_SOFTWARE=1 ./renderbench
+
+enum DrawPath
+{
+    DRAW_CALLS,
+    DRAW_INSTANCED,
+    DRAW_QUADS
+};
+
+const int benchWidth = 1800;
+const int benchHeight = 900;
+
+// Pixels may differ along edges, DrawCircleV tessellates
+const float maxMismatch = 0.02f;
+
+double RenderFrames(DrawPath path, CircleBatch &batch, const CircleInstance circles[], int count, int frames, RenderTexture2D target);
+float CompareImages(Image a, Image b);
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(benchWidth, benchHeight, "renderbench");
+    RenderTexture2D target = LoadRenderTexture(benchWidth, benchHeight);
+
+    // Fixed seed so every path draws the same scene
+    CircleInstance *circles = new CircleInstance[count];
+    std::srand(1);
+    for (int i = 0; i < count; ++i)
+    {
+        circles[i] = {(float)(std::rand() % benchWidth), (float)(std::rand() % benchHeight), (float)(4 + std::rand() % 27),
+                      {(unsigned char)(std::rand() % 256), (unsigned char)(std::rand() % 256), (unsigned char)(std::rand() % 256), 255}};
+    }
+
+    CircleBatch instanced;
+    InitCircleBatch(instanced, true);
+    CircleBatch quads;
+    InitCircleBatch(quads, false);
+
+    const char *names[3] = {"DrawCircleV", "instanced", "textured quads"};
+    CircleBatch *batches[3] = {&quads, &instanced, &quads};
+    Image images[3];
+    int result = 0;
+
+    std::printf("circles: %d frames: %d\n", count, frames);
+    for (int path = DRAW_CALLS; path <= DRAW_QUADS; ++path)
+    {
+        if (path == DRAW_INSTANCED && !instanced.instanced)
+        {
+            std::printf("%-15s unavailable on this OpenGL version\n", names[path]);
+            images[path] = {0};
+            continue;
+        }
+
+        double seconds = RenderFrames((DrawPath)path, *batches[path], circles, count, frames, target);
+        images[path] = LoadImageFromTexture(target.texture);
+
+        std::printf("%-15s %8.3f ms/frame", names[path], 1000.0 * seconds / frames);
+        if (path != DRAW_CALLS)
+        {
+            float mismatch = CompareImages(images[DRAW_CALLS], images[path]);
+            std::printf("  %5.2f%% pixels differ", 100.0f * mismatch);
+            if (mismatch > maxMismatch)
+            {
+                std::printf("  FAIL");
+                result = 1;
+            }
+        }
+        std::printf("\n");
+    }
+
+    for (Image &image : images)
+    {
+        if (image.data)
+        {
+            UnloadImage(image);
+        }
+    }
+    UnloadCircleBatch(quads);
+    UnloadCircleBatch(instanced);
+    delete[] circles;
+    UnloadRenderTexture(target);
+    CloseWindow();
+    return result;
+}
+
+double RenderFrames(DrawPath path, CircleBatch &batch, const CircleInstance circles[], int count, int frames, RenderTexture2D target)
+{
+    double start = GetTime();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        BeginTextureMode(target);
+        ClearBackground(GRAY);
+        if (path == DRAW_CALLS)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                DrawCircleV({circles[i].x, circles[i].y}, circles[i].radius, circles[i].color);
+            }
+        }
+        else
+        {
+            ClearCircleBatch(batch);
+            for (int i = 0; i < count; ++i)
+            {
+                AddCircle(batch, circles[i].x, circles[i].y, circles[i].radius, circles[i].color);
+            }
+            DrawCircleBatch(batch);
+        }
+        EndTextureMode();
+    }
+
+    // Reading the target back waits for the GPU to finish
+    Image image = LoadImageFromTexture(target.texture);
+    UnloadImage(image);
+    return GetTime() - start;
+}
+
+// Fraction of pixels whose channels differ by more than a small tolerance
+float CompareImages(Image a, Image b)
+{
+    const unsigned char *pixelsA = (const unsigned char *)a.data;
+    const unsigned char *pixelsB = (const unsigned char *)b.data;
+    int pixels = a.width * a.height;
+    int different = 0;
+
+    for (int i = 0; i < pixels * 4; i += 4)
+    {
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            if (std::abs(pixelsA[i + channel] - pixelsB[i + channel]) > 8)
+            {
+                different++;
+                break;
+            }
+        }
+    }
+
+    return pixels > 0 ? (float)different / pixels : 0.0f;
+}